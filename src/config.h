@@ -4,6 +4,8 @@ namespace AppConfig {
     // Serial and timing
     inline constexpr unsigned long SERIAL_BAUD_RATE = 115200;
     inline constexpr unsigned long STATUS_UPDATE_INTERVAL_MS = 1000;
+    inline constexpr unsigned long LOOP_DELAY_MS = 100;          // loop()の待機時間
+    inline constexpr unsigned long LOOP_DELAY_FAST_MS = 2;       // UDP受信有効時・スナップショット符号化中のloop()待機時間
 
     // Display settings
     inline constexpr uint8_t DISPLAY_BRIGHTNESS = 200; // 0-255
@@ -23,6 +25,31 @@ namespace AppConfig {
     inline const char* MQTT_TOPIC_PUBLISH = "fromIPB2000-2_display";   // 送信トピック
     inline const char* MQTT_CLIENT_ID = "IPB2000_display_01";
     inline const char* MQTT_DEVICE_ID = "IPB2000_display_01";  // このデバイスのID
+    inline constexpr uint16_t MQTT_BUFFER_SIZE = 2048;  // 送信JSONバッファ（set_config/get_configのJSON用）
+    inline constexpr uint16_t MQTT_PACKET_BUFFER_SIZE = 8192;  // PubSubClientの送受信バッファ（スナップショットのチャンクを含む）
+    inline constexpr unsigned int MQTT_INBOUND_MAX_LEN = 2048; // 受信メッセージの最大長（これを超えるものは破棄）
+
+    // UDPマルチキャスト受信（高速信号用、MQTTはコマンド・ステータス用に併用）
+    // ペイロードはMQTTと同じJSON＋"seq"（必須）、"src"・"ts"（任意）
+    inline constexpr bool UDP_INGEST_ENABLED = false;
+    inline const char* UDP_MULTICAST_GROUP = "239.1.20.1";
+    inline constexpr uint16_t UDP_MULTICAST_PORT = 5020;
+    inline constexpr int UDP_MAX_SOURCES = 4;              // 統計を保持する送信元数
+    inline constexpr int UDP_MAX_PACKETS_PER_LOOP = 16;    // 1回のloop()で処理するパケット数の上限
+    inline constexpr size_t UDP_PACKET_MAX_LEN = 512;      // 受信パケットの最大長
+    inline constexpr uint32_t UDP_REORDER_WINDOW = 64;     // 順序入れ替わりとみなす範囲（これより古い番号は遅着として破棄）
+    inline constexpr uint32_t UDP_RESTART_CONFIRM = 3;     // 範囲より古い番号がこの数だけ昇順に続いたら送信元再起動とみなす
+    // 注: UDP_REORDER_WINDOW未満の番号数で再起動した送信元（例: 0..30の後に0から再送）は番号だけでは
+    //     検出できず、新しいパケットが重複として破棄される。送信元は起動ごとに変わる"boot"を付けること
+    //     （"boot"が変わると番号に関係なく再同期する）
+
+    // 画面スナップショット（snapshot / snapshot_streamコマンド）
+    inline const char* SNAPSHOT_TOPIC = "fromIPB2000-2_display/snapshot";  // バイナリのタイルチャンク送信先
+    inline constexpr int SNAPSHOT_TILE_SIZE = 32;                  // タイルの一辺（画素）
+    inline constexpr size_t SNAPSHOT_CHUNK_MAX_LEN = 6144;         // 1メッセージの最大長（MQTT_PACKET_BUFFER_SIZE未満）
+    inline constexpr unsigned long SNAPSHOT_LOOP_BUDGET_US = 3000; // 1回のloop()で符号化に使う時間の上限（送信は1回1チャンクまで）
+    inline constexpr unsigned long SNAPSHOT_STREAM_INTERVAL_MS = 1000;     // ストリーミングの既定間隔
+    inline constexpr unsigned long SNAPSHOT_STREAM_MIN_INTERVAL_MS = 200;  // ストリーミング間隔の下限
     
     // MQTT Data Mapping (JSONキー → データアイテムインデックス)
     // 例: {"device_id":"IPB2000_display_01","oil_pressure":123.45,"parison_temp":192.8,"injection_time":345.9}
@@ -70,4 +97,17 @@ namespace AppConfig {
     inline constexpr int VALUE_DECIMAL_PLACES = 1;  // 小数点以下の桁数
     inline constexpr int VALUE_TOTAL_WIDTH = 6;     // 全体の桁数（ゼロパディング用）
     inline constexpr int VALUE_RIGHT_ALIGN_X = 650; // 数値の右寄せ位置（セクション右端からの距離）
+
+    // 帯単位描画（PSRAMのフルフレームスプライトが作成できない場合の描画方式）
+    inline constexpr int RENDER_STRIP_HEIGHT = 40;              // 帯の高さ（内部SRAMに2本確保）
+    inline constexpr bool RENDER_STRIP_SKIP_UNCHANGED = true;   // 前回から変化のない帯は転送しない
+    inline constexpr int RENDER_BENCH_FRAMES = 30;              // render_benchコマンドの計測フレーム数
+
+    // レイアウト設定の保存（MQTTのset_configで変更、上記の値が既定値）
+    inline const char* LAYOUT_NVS_NAMESPACE = "layout";
+    inline constexpr uint32_t LAYOUT_NVS_VERSION = 1;   // LayoutConfig構造変更時に更新
+    inline constexpr int LAYOUT_COORD_MAX = 2000;       // 座標・サイズの上限
+    inline constexpr int LAYOUT_FONT_SCALE_MAX = 8;     // フォント拡大率の上限
+    inline constexpr int LAYOUT_DECIMAL_PLACES_MAX = 6; // 小数点以下桁数の上限
+    inline constexpr int LAYOUT_TOTAL_WIDTH_MAX = 15;   // 全体桁数の上限
 }
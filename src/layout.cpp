@@ -0,0 +1,368 @@
+#include "layout.h"
+#include "config.h"
+#include <Preferences.h>
+
+// 現在の設定
+static LayoutConfig currentLayout;
+
+// NVSのキー
+static const char* NVS_KEY_VERSION = "version";
+static const char* NVS_KEY_BLOB = "config";
+
+// 文字列を終端付きでコピー
+static void copyText(char* dst, size_t dstLen, const char* src) {
+    strncpy(dst, src, dstLen - 1);
+    dst[dstLen - 1] = '\0';
+}
+
+// config.hの値から既定設定を作成
+static void buildDefaults(LayoutConfig& cfg) {
+    cfg.sections[0] = {AppConfig::SECTION1_X, AppConfig::SECTION1_Y,
+                       AppConfig::SECTION1_WIDTH, AppConfig::SECTION1_HEIGHT};
+    cfg.sections[1] = {AppConfig::SECTION2_X, AppConfig::SECTION2_Y,
+                       AppConfig::SECTION2_WIDTH, AppConfig::SECTION2_HEIGHT};
+    cfg.sections[2] = {AppConfig::SECTION3_X, AppConfig::SECTION3_Y,
+                       AppConfig::SECTION3_WIDTH, AppConfig::SECTION3_HEIGHT};
+    cfg.titleOffset = {AppConfig::TEXT_TITLE_OFFSET_X, AppConfig::TEXT_TITLE_OFFSET_Y};
+    cfg.currentOffset = {AppConfig::TEXT_CURRENT_OFFSET_X, AppConfig::TEXT_CURRENT_OFFSET_Y};
+    cfg.previousOffset = {AppConfig::TEXT_PREVIOUS_OFFSET_X, AppConfig::TEXT_PREVIOUS_OFFSET_Y};
+    cfg.fontTitleScale = AppConfig::FONT_TITLE_SCALE;
+    cfg.fontValueScale = AppConfig::FONT_VALUE_SCALE;
+    cfg.valueDecimalPlaces = AppConfig::VALUE_DECIMAL_PLACES;
+    cfg.valueTotalWidth = AppConfig::VALUE_TOTAL_WIDTH;
+    cfg.valueRightAlignX = AppConfig::VALUE_RIGHT_ALIGN_X;
+
+    copyText(cfg.titles[0], LAYOUT_TITLE_MAX_LEN, AppConfig::DATA_TITLE_1);
+    copyText(cfg.titles[1], LAYOUT_TITLE_MAX_LEN, AppConfig::DATA_TITLE_2);
+    copyText(cfg.titles[2], LAYOUT_TITLE_MAX_LEN, AppConfig::DATA_TITLE_3);
+    copyText(cfg.keys[0], LAYOUT_KEY_MAX_LEN, AppConfig::MQTT_KEY_DATA1);
+    copyText(cfg.keys[1], LAYOUT_KEY_MAX_LEN, AppConfig::MQTT_KEY_DATA2);
+    copyText(cfg.keys[2], LAYOUT_KEY_MAX_LEN, AppConfig::MQTT_KEY_DATA3);
+}
+
+// set_configで指定できるキー
+static const char* const CONFIG_KEYS[] = {
+    "sections", "title_offset", "current_offset", "previous_offset",
+    "font_title_scale", "font_value_scale", "decimal_places", "total_width",
+    "right_align_x", "titles", "keys",
+};
+static const char* const OFFSET_KEYS[] = {"x", "y"};
+static const char* const SECTION_KEYS[] = {"x", "y", "w", "h"};
+
+// オブジェクトに未知のキーがないか確認（スペルミスを無視せずエラーにする）
+template <size_t N>
+static bool checkKeys(JsonObjectConst object, const char* const (&allowed)[N], const char* name,
+                      char* error, size_t errorLen) {
+    for (JsonPairConst pair : object) {
+        bool known = false;
+        for (const char* key : allowed) {
+            if (strcmp(pair.key().c_str(), key) == 0) {
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            snprintf(error, errorLen, "unknown key in %s: %s", name, pair.key().c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// 整数値を範囲チェックして読み込む（キーがなければ変更しない）
+static bool readInt(JsonVariantConst json, const char* key, int minValue, int maxValue,
+                    int& target, char* error, size_t errorLen) {
+    JsonVariantConst value = json[key];
+    if (value.isNull()) return true;
+
+    if (!value.is<int>()) {
+        snprintf(error, errorLen, "%s must be an integer", key);
+        return false;
+    }
+    int intValue = value.as<int>();
+    if (intValue < minValue || intValue > maxValue) {
+        snprintf(error, errorLen, "%s out of range (%d-%d)", key, minValue, maxValue);
+        return false;
+    }
+    target = intValue;
+    return true;
+}
+
+// テキストオフセット {"x":..,"y":..} を読み込む
+static bool readOffset(JsonVariantConst json, const char* key, TextOffset& target,
+                       char* error, size_t errorLen) {
+    JsonVariantConst value = json[key];
+    if (value.isNull()) return true;
+
+    if (!value.is<JsonObjectConst>()) {
+        snprintf(error, errorLen, "%s must be an object", key);
+        return false;
+    }
+    return checkKeys(value.as<JsonObjectConst>(), OFFSET_KEYS, key, error, errorLen) &&
+           readInt(value, "x", 0, AppConfig::LAYOUT_COORD_MAX, target.x, error, errorLen) &&
+           readInt(value, "y", 0, AppConfig::LAYOUT_COORD_MAX, target.y, error, errorLen);
+}
+
+// セクション矩形の配列を読み込む（nullの要素は変更しない）
+static bool readSections(JsonVariantConst json, LayoutConfig& cfg, char* error, size_t errorLen) {
+    if (json["sections"].isNull()) return true;
+    if (!json["sections"].is<JsonArrayConst>()) {
+        snprintf(error, errorLen, "sections must be an array");
+        return false;
+    }
+
+    JsonArrayConst sections = json["sections"];
+    if (sections.size() > LAYOUT_DATA_COUNT) {
+        snprintf(error, errorLen, "sections must have at most %d entries", LAYOUT_DATA_COUNT);
+        return false;
+    }
+
+    int index = 0;
+    for (JsonVariantConst section : sections) {
+        if (!section.isNull()) {
+            if (!section.is<JsonObjectConst>()) {
+                snprintf(error, errorLen, "sections[%d] must be an object", index);
+                return false;
+            }
+            SectionRect& rect = cfg.sections[index];
+            if (!checkKeys(section.as<JsonObjectConst>(), SECTION_KEYS, "sections", error, errorLen) ||
+                !readInt(section, "x", 0, AppConfig::LAYOUT_COORD_MAX, rect.x, error, errorLen) ||
+                !readInt(section, "y", 0, AppConfig::LAYOUT_COORD_MAX, rect.y, error, errorLen) ||
+                !readInt(section, "w", 1, AppConfig::LAYOUT_COORD_MAX, rect.width, error, errorLen) ||
+                !readInt(section, "h", 1, AppConfig::LAYOUT_COORD_MAX, rect.height, error, errorLen)) {
+                return false;
+            }
+        }
+        index++;
+    }
+    return true;
+}
+
+// 文字列配列（titles / keys）を読み込む
+static bool readTextArray(JsonVariantConst json, const char* key, char (*target)[LAYOUT_TITLE_MAX_LEN],
+                          char* error, size_t errorLen) {
+    if (json[key].isNull()) return true;
+    if (!json[key].is<JsonArrayConst>()) {
+        snprintf(error, errorLen, "%s must be an array", key);
+        return false;
+    }
+
+    JsonArrayConst values = json[key];
+    if (values.size() > LAYOUT_DATA_COUNT) {
+        snprintf(error, errorLen, "%s must have at most %d entries", key, LAYOUT_DATA_COUNT);
+        return false;
+    }
+
+    int index = 0;
+    for (JsonVariantConst value : values) {
+        if (!value.isNull()) {
+            if (!value.is<const char*>() || strlen(value.as<const char*>()) >= LAYOUT_TITLE_MAX_LEN) {
+                snprintf(error, errorLen, "%s[%d] must be a string shorter than %u bytes",
+                         key, index, (unsigned)LAYOUT_TITLE_MAX_LEN);
+                return false;
+            }
+            copyText(target[index], LAYOUT_TITLE_MAX_LEN, value.as<const char*>());
+        }
+        index++;
+    }
+    return true;
+}
+
+// キー配列を読み込む（空文字は不可）
+static bool readKeys(JsonVariantConst json, char (*target)[LAYOUT_KEY_MAX_LEN],
+                     char* error, size_t errorLen) {
+    if (json["keys"].isNull()) return true;
+    if (!json["keys"].is<JsonArrayConst>()) {
+        snprintf(error, errorLen, "keys must be an array");
+        return false;
+    }
+
+    JsonArrayConst values = json["keys"];
+    if (values.size() > LAYOUT_DATA_COUNT) {
+        snprintf(error, errorLen, "keys must have at most %d entries", LAYOUT_DATA_COUNT);
+        return false;
+    }
+
+    int index = 0;
+    for (JsonVariantConst value : values) {
+        if (!value.isNull()) {
+            const char* key = value.as<const char*>();
+            if (!value.is<const char*>() || key[0] == '\0' || strlen(key) >= LAYOUT_KEY_MAX_LEN) {
+                snprintf(error, errorLen, "keys[%d] must be a non-empty string shorter than %u bytes",
+                         index, (unsigned)LAYOUT_KEY_MAX_LEN);
+                return false;
+            }
+            copyText(target[index], LAYOUT_KEY_MAX_LEN, key);
+        }
+        index++;
+    }
+    return true;
+}
+
+// 値が範囲内か
+static bool inRange(int value, int minValue, int maxValue) {
+    return value >= minValue && value <= maxValue;
+}
+
+// NVSから読み込んだ設定を検証（別ビルドの保存値・破損に備え、set_configと同じ範囲を確認）
+// 文字列は終端を強制する
+static bool validateLoaded(LayoutConfig& cfg) {
+    const int coordMax = AppConfig::LAYOUT_COORD_MAX;
+    for (const SectionRect& rect : cfg.sections) {
+        if (!inRange(rect.x, 0, coordMax) || !inRange(rect.y, 0, coordMax) ||
+            !inRange(rect.width, 1, coordMax) || !inRange(rect.height, 1, coordMax)) {
+            return false;
+        }
+    }
+    for (const TextOffset* offset : {&cfg.titleOffset, &cfg.currentOffset, &cfg.previousOffset}) {
+        if (!inRange(offset->x, 0, coordMax) || !inRange(offset->y, 0, coordMax)) {
+            return false;
+        }
+    }
+    if (!inRange(cfg.fontTitleScale, 1, AppConfig::LAYOUT_FONT_SCALE_MAX) ||
+        !inRange(cfg.fontValueScale, 1, AppConfig::LAYOUT_FONT_SCALE_MAX) ||
+        !inRange(cfg.valueDecimalPlaces, 0, AppConfig::LAYOUT_DECIMAL_PLACES_MAX) ||
+        !inRange(cfg.valueTotalWidth, 1, AppConfig::LAYOUT_TOTAL_WIDTH_MAX) ||
+        !inRange(cfg.valueRightAlignX, 0, coordMax)) {
+        return false;
+    }
+
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
+        cfg.titles[i][LAYOUT_TITLE_MAX_LEN - 1] = '\0';
+        cfg.keys[i][LAYOUT_KEY_MAX_LEN - 1] = '\0';
+        if (cfg.keys[i][0] == '\0') return false;
+    }
+    return true;
+}
+
+// NVSから設定を読み込む
+void layoutLoad() {
+    buildDefaults(currentLayout);
+
+    Preferences preferences;
+    if (!preferences.begin(AppConfig::LAYOUT_NVS_NAMESPACE, true)) {
+        Serial.println("Layout: no saved config, using defaults");
+        return;
+    }
+
+    uint32_t version = preferences.getUInt(NVS_KEY_VERSION, 0);
+    size_t storedLen = preferences.getBytesLength(NVS_KEY_BLOB);
+
+    if (version == AppConfig::LAYOUT_NVS_VERSION && storedLen == sizeof(LayoutConfig)) {
+        LayoutConfig loaded;
+        if (preferences.getBytes(NVS_KEY_BLOB, &loaded, sizeof(loaded)) == sizeof(loaded) &&
+            validateLoaded(loaded)) {
+            currentLayout = loaded;
+            Serial.println("Layout: loaded from NVS");
+        } else {
+            Serial.println("Layout: saved config invalid, using defaults");
+        }
+    } else if (storedLen > 0) {
+        Serial.printf("Layout: saved config incompatible (version=%u, size=%u), using defaults\n",
+                      (unsigned)version, (unsigned)storedLen);
+    }
+    preferences.end();
+}
+
+// 現在の設定をNVSに保存
+bool layoutSave() {
+    Preferences preferences;
+    if (!preferences.begin(AppConfig::LAYOUT_NVS_NAMESPACE, false)) {
+        Serial.println("Layout: failed to open NVS");
+        return false;
+    }
+
+    bool saved = preferences.putBytes(NVS_KEY_BLOB, &currentLayout, sizeof(currentLayout)) == sizeof(currentLayout) &&
+                 preferences.putUInt(NVS_KEY_VERSION, AppConfig::LAYOUT_NVS_VERSION) > 0;
+    preferences.end();
+
+    Serial.println(saved ? "Layout: saved to NVS" : "Layout: failed to save to NVS");
+    return saved;
+}
+
+// 現在の設定を取得
+const LayoutConfig& layoutGet() {
+    return currentLayout;
+}
+
+// 既定値に戻す
+void layoutResetDefaults() {
+    buildDefaults(currentLayout);
+}
+
+// JSONの部分設定を検証して反映
+bool layoutApplyJson(JsonVariantConst json, char* error, size_t errorLen) {
+    if (!json.is<JsonObjectConst>()) {
+        snprintf(error, errorLen, "config must be an object");
+        return false;
+    }
+
+    // 作業コピーに反映し、すべて検証できた場合のみ確定する
+    LayoutConfig updated = currentLayout;
+
+    bool valid =
+        checkKeys(json.as<JsonObjectConst>(), CONFIG_KEYS, "config", error, errorLen) &&
+        readSections(json, updated, error, errorLen) &&
+        readOffset(json, "title_offset", updated.titleOffset, error, errorLen) &&
+        readOffset(json, "current_offset", updated.currentOffset, error, errorLen) &&
+        readOffset(json, "previous_offset", updated.previousOffset, error, errorLen) &&
+        readInt(json, "font_title_scale", 1, AppConfig::LAYOUT_FONT_SCALE_MAX,
+                updated.fontTitleScale, error, errorLen) &&
+        readInt(json, "font_value_scale", 1, AppConfig::LAYOUT_FONT_SCALE_MAX,
+                updated.fontValueScale, error, errorLen) &&
+        readInt(json, "decimal_places", 0, AppConfig::LAYOUT_DECIMAL_PLACES_MAX,
+                updated.valueDecimalPlaces, error, errorLen) &&
+        readInt(json, "total_width", 1, AppConfig::LAYOUT_TOTAL_WIDTH_MAX,
+                updated.valueTotalWidth, error, errorLen) &&
+        readInt(json, "right_align_x", 0, AppConfig::LAYOUT_COORD_MAX,
+                updated.valueRightAlignX, error, errorLen) &&
+        readTextArray(json, "titles", updated.titles, error, errorLen) &&
+        readKeys(json, updated.keys, error, errorLen);
+
+    if (!valid) {
+        Serial.printf("Layout: invalid config (%s)\n", error);
+        return false;
+    }
+
+    currentLayout = updated;
+    return true;
+}
+
+// 現在の設定をJSONに書き出す
+void layoutToJson(JsonObject out) {
+    JsonArray sections = out["sections"].to<JsonArray>();
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
+        JsonObject section = sections.add<JsonObject>();
+        section["x"] = currentLayout.sections[i].x;
+        section["y"] = currentLayout.sections[i].y;
+        section["w"] = currentLayout.sections[i].width;
+        section["h"] = currentLayout.sections[i].height;
+    }
+
+    const struct {
+        const char* key;
+        const TextOffset& offset;
+    } offsets[] = {
+        {"title_offset", currentLayout.titleOffset},
+        {"current_offset", currentLayout.currentOffset},
+        {"previous_offset", currentLayout.previousOffset},
+    };
+    for (const auto& entry : offsets) {
+        JsonObject offset = out[entry.key].to<JsonObject>();
+        offset["x"] = entry.offset.x;
+        offset["y"] = entry.offset.y;
+    }
+
+    out["font_title_scale"] = currentLayout.fontTitleScale;
+    out["font_value_scale"] = currentLayout.fontValueScale;
+    out["decimal_places"] = currentLayout.valueDecimalPlaces;
+    out["total_width"] = currentLayout.valueTotalWidth;
+    out["right_align_x"] = currentLayout.valueRightAlignX;
+
+    JsonArray titles = out["titles"].to<JsonArray>();
+    JsonArray keys = out["keys"].to<JsonArray>();
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
+        titles.add(currentLayout.titles[i]);
+        keys.add(currentLayout.keys[i]);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// 表示データ数（セクション数）
+inline constexpr int LAYOUT_DATA_COUNT = 3;
+
+// 文字列設定の最大長（終端含む）
+inline constexpr size_t LAYOUT_TITLE_MAX_LEN = 48;
+inline constexpr size_t LAYOUT_KEY_MAX_LEN = 32;
+
+// セクションの矩形
+struct SectionRect {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// セクション左上からの相対位置
+struct TextOffset {
+    int x;
+    int y;
+};
+
+// 実行時に変更可能なレイアウト・書式・キーマッピング設定
+// config.hの値を既定値とし、MQTTのset_configで更新してNVSに保存する
+struct LayoutConfig {
+    SectionRect sections[LAYOUT_DATA_COUNT];
+    TextOffset titleOffset;
+    TextOffset currentOffset;
+    TextOffset previousOffset;
+    int fontTitleScale;
+    int fontValueScale;
+    int valueDecimalPlaces;
+    int valueTotalWidth;
+    int valueRightAlignX;
+    char titles[LAYOUT_DATA_COUNT][LAYOUT_TITLE_MAX_LEN];
+    char keys[LAYOUT_DATA_COUNT][LAYOUT_KEY_MAX_LEN];
+};
+
+// NVSから設定を読み込む（未保存・形式不一致ならconfig.hの既定値）
+void layoutLoad();
+
+// 現在の設定をNVSに保存
+bool layoutSave();
+
+// 現在の設定を取得
+const LayoutConfig& layoutGet();
+
+// config.hの既定値に戻す（NVSへの保存は呼び出し側で行う）
+void layoutResetDefaults();
+
+// JSONの部分設定を検証して現在の設定に反映
+// 検証エラー時は現在の設定を変更せず、errorにメッセージを格納してfalseを返す
+bool layoutApplyJson(JsonVariantConst json, char* error, size_t errorLen);
+
+// 現在の設定をJSONに書き出す（set_configと同じ形式）
+void layoutToJson(JsonObject out);
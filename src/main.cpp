@@ -4,6 +4,11 @@
 #include <Preferences.h>
 #include "config.h"
 #include "mqtt.h"
+#include "layout.h"
+#include "renderer.h"
+#include "udp_ingest.h"
+#include "snapshot.h"
+#include "strip_renderer.h"
 
 // M5GFXの日本語フォントを使用
 #include <lgfx/v1/lgfx_fonts.hpp>
@@ -20,19 +25,15 @@ Preferences preferences;
 #define SDIO2_D3  GPIO_NUM_8
 #define SDIO2_RST GPIO_NUM_15
 
-// データ構造
-struct DataItem {
-    const char* title;
-    float currentValue;
-    float previousValue;
+// 3つのデータアイテム（起動時は0、タイトルはレイアウト設定で管理）
+DataItem dataItems[LAYOUT_DATA_COUNT] = {
+    {0.0, 0.0},
+    {0.0, 0.0},
+    {0.0, 0.0}
 };
 
-// 3つのデータアイテム（起動時は0）
-DataItem dataItems[3] = {
-    {AppConfig::DATA_TITLE_1, 0.0, 0.0},
-    {AppConfig::DATA_TITLE_2, 0.0, 0.0},
-    {AppConfig::DATA_TITLE_3, 0.0, 0.0}
-};
+// 値が更新され、まだ画面に反映していないか（loop()で1回だけ再描画する）
+bool displayDirty = false;
 
 // スプライト（オフスクリーンバッファ）
 LGFX_Sprite sprite(&M5.Display);
@@ -42,18 +43,24 @@ WiFiClient wifiClient;
 
 // 関数の前方宣言
 void displayAllData();
+void runRenderBenchmark();
+
+// フルフレームのスプライトが使用可能か
+bool isSpriteReady() {
+    return sprite.width() > 0 && sprite.height() > 0;
+}
 
-// データ更新コールバック（MQTTから呼ばれる）
+// データ更新コールバック（MQTT・UDPから呼ばれる）
 void onDataUpdate(int index, float value) {
-    if (index < 0 || index >= 3) return;
+    if (index < 0 || index >= LAYOUT_DATA_COUNT) return;
     
     // 現在値を前回値に移動
     dataItems[index].previousValue = dataItems[index].currentValue;
     // 新しい値を設定
     dataItems[index].currentValue = value;
     
-    // 画面を即座に更新
-    displayAllData();
+    // 再描画はloop()で受信処理の後にまとめて1回行う
+    displayDirty = true;
 }
 
 // コマンドコールバック（MQTTから呼ばれる）
@@ -71,17 +78,27 @@ void onCommand(const char* command) {
         
         delay(3000);
         ESP.restart();  // システムリセット
+    } else if (strcmp(command, "render_bench") == 0) {
+        runRenderBenchmark();
     }
 }
 
 // データ取得コールバック（MQTTから呼ばれる）
 void onGetData(int index, float* currentValue, float* previousValue) {
-    if (index < 0 || index >= 3) return;
+    if (index < 0 || index >= LAYOUT_DATA_COUNT) return;
     
     *currentValue = dataItems[index].currentValue;
     *previousValue = dataItems[index].previousValue;
 }
 
+// レイアウト変更コールバック（MQTTのset_config/reset_config後に呼ばれる）
+void onLayoutChanged() {
+    // 再起動せずにレンダープランを再作成して即時反映
+    rendererCompile(layoutGet(), &M5.Display, M5.Display.width(), M5.Display.height(), isSpriteReady());
+    stripRendererInvalidate();
+    displayAllData();
+}
+
 // WiFi選択関数（タッチパネルで選択）
 int selectWiFi() {
     // 前回の選択を読み込み
@@ -246,96 +263,112 @@ bool connectWiFi(int wifiIndex) {
     return true;
 }
 
-void displayDataItem(LGFX_Sprite* spr, int index, int sectionX, int sectionY, int sectionW, int sectionH) {
-    // セクションの矩形枠を描画
-    spr->drawRect(sectionX, sectionY, sectionW, sectionH, WHITE);
-    
-    // すべてゴシック40フォントを使用
-    spr->setFont(&fonts::lgfxJapanGothic_40);
-    
-    // タイトル
-    spr->setTextSize(AppConfig::FONT_TITLE_SCALE);
-    spr->setTextColor(CYAN, BLACK);
-    spr->setCursor(sectionX + AppConfig::TEXT_TITLE_OFFSET_X, 
-                   sectionY + AppConfig::TEXT_TITLE_OFFSET_Y);
-    spr->printf("%s:", dataItems[index].title);
-    
-    // 今回値ラベル
-    spr->setTextSize(1);
-    spr->setTextColor(WHITE, BLACK);
-    spr->setCursor(sectionX + AppConfig::TEXT_CURRENT_OFFSET_X, 
-                   sectionY + AppConfig::TEXT_CURRENT_OFFSET_Y);
-    spr->print("今回値: ");
-    
-    // 今回値の数値（右寄せ、3倍表示、ゼロパディング）
-    char valueStr[20];
-    snprintf(valueStr, sizeof(valueStr), "%0*.*f", 
-             AppConfig::VALUE_TOTAL_WIDTH, 
-             AppConfig::VALUE_DECIMAL_PLACES, 
-             dataItems[index].currentValue);
-    
-    spr->setTextSize(AppConfig::FONT_VALUE_SCALE);
-    int32_t textWidth = spr->textWidth(valueStr);
-    spr->setCursor(sectionX + AppConfig::VALUE_RIGHT_ALIGN_X - textWidth, 
-                   sectionY + AppConfig::TEXT_CURRENT_OFFSET_Y);
-    spr->print(valueStr);
-    
-    // 前回値ラベル
-    spr->setTextSize(1);
-    spr->setTextColor(DARKGREY, BLACK);
-    spr->setCursor(sectionX + AppConfig::TEXT_PREVIOUS_OFFSET_X, 
-                   sectionY + AppConfig::TEXT_PREVIOUS_OFFSET_Y);
-    spr->print("前回値: ");
-    
-    // 前回値の数値（右寄せ、3倍表示、ゼロパディング）
-    snprintf(valueStr, sizeof(valueStr), "%0*.*f", 
-             AppConfig::VALUE_TOTAL_WIDTH, 
-             AppConfig::VALUE_DECIMAL_PLACES, 
-             dataItems[index].previousValue);
-    
-    spr->setTextSize(AppConfig::FONT_VALUE_SCALE);
-    textWidth = spr->textWidth(valueStr);
-    spr->setCursor(sectionX + AppConfig::VALUE_RIGHT_ALIGN_X - textWidth, 
-                   sectionY + AppConfig::TEXT_PREVIOUS_OFFSET_Y);
-    spr->print(valueStr);
-}
-
 void displayAllData() {
+    displayDirty = false;
+    
     // スプライトが正常に作成されている場合のみ使用
-    if (sprite.width() > 0 && sprite.height() > 0) {
-        // スプライトに描画（オフスクリーン）
-        sprite.fillScreen(BLACK);
-        
-        // 3つのデータセクションを描画（上・中・下）
-        displayDataItem(&sprite, 0, 
-                       AppConfig::SECTION1_X, AppConfig::SECTION1_Y,
-                       AppConfig::SECTION1_WIDTH, AppConfig::SECTION1_HEIGHT);
-        
-        displayDataItem(&sprite, 1,
-                       AppConfig::SECTION2_X, AppConfig::SECTION2_Y,
-                       AppConfig::SECTION2_WIDTH, AppConfig::SECTION2_HEIGHT);
-        
-        displayDataItem(&sprite, 2,
-                       AppConfig::SECTION3_X, AppConfig::SECTION3_Y,
-                       AppConfig::SECTION3_WIDTH, AppConfig::SECTION3_HEIGHT);
+    if (isSpriteReady()) {
+        // レンダープランに従ってスプライトに合成（オフスクリーン）
+        rendererComposeFrame(&sprite, dataItems);
         
         // スプライトを画面に一気に転送（ちらつき防止）
         sprite.pushSprite(0, 0);
+    } else if (stripRendererIsReady()) {
+        // スプライト失敗時は内部SRAMの帯バッファで合成して帯ごとに転送
+        stripRendererDraw(dataItems, AppConfig::RENDER_STRIP_SKIP_UNCHANGED);
     } else {
-        // スプライト失敗時は直接画面に描画
+        // 帯バッファも確保できない場合は直接画面に描画
         M5.Display.fillScreen(BLACK);
-        
-        displayDataItem((LGFX_Sprite*)&M5.Display, 0,
-                       AppConfig::SECTION1_X, AppConfig::SECTION1_Y,
-                       AppConfig::SECTION1_WIDTH, AppConfig::SECTION1_HEIGHT);
-        
-        displayDataItem((LGFX_Sprite*)&M5.Display, 1,
-                       AppConfig::SECTION2_X, AppConfig::SECTION2_Y,
-                       AppConfig::SECTION2_WIDTH, AppConfig::SECTION2_HEIGHT);
-        
-        displayDataItem((LGFX_Sprite*)&M5.Display, 2,
-                       AppConfig::SECTION3_X, AppConfig::SECTION3_Y,
-                       AppConfig::SECTION3_WIDTH, AppConfig::SECTION3_HEIGHT);
+        rendererDrawStatic(&M5.Display);
+        rendererDrawValues(&M5.Display, dataItems);
+    }
+}
+
+// ベンチマーク用の表示データ（フレームごとに1項目ずつ値を変える）
+void makeBenchmarkItems(DataItem* items, int frame) {
+    memcpy(items, dataItems, sizeof(dataItems));
+    DataItem& changed = items[frame % LAYOUT_DATA_COUNT];
+    changed.previousValue = changed.currentValue;
+    changed.currentValue += 0.1f * (frame + 1);
+}
+
+// フルフレーム（PSRAMスプライト）方式の計測
+void benchmarkFullFrame(JsonObject result, int frames) {
+    DataItem items[LAYOUT_DATA_COUNT];
+    uint32_t composeUs = 0;
+    uint32_t pushUs = 0;
+    
+    for (int frame = 0; frame < frames; frame++) {
+        makeBenchmarkItems(items, frame);
+        uint32_t start = micros();
+        rendererComposeFrame(&sprite, items);
+        uint32_t composed = micros();
+        sprite.pushSprite(0, 0);
+        M5.Display.waitDisplay();
+        composeUs += composed - start;
+        pushUs += micros() - composed;
+    }
+    
+    result["compose_us"] = composeUs / frames;
+    result["push_us"] = pushUs / frames;
+    result["frame_us"] = (composeUs + pushUs) / frames;
+}
+
+// 帯単位（内部SRAM）方式の計測
+void benchmarkStrips(JsonObject result, int frames, bool skipUnchanged) {
+    DataItem items[LAYOUT_DATA_COUNT];
+    uint32_t totalUs = 0;
+    uint32_t pushedStrips = 0;
+    
+    stripRendererInvalidate();
+    for (int frame = 0; frame < frames; frame++) {
+        makeBenchmarkItems(items, frame);
+        uint32_t start = micros();
+        pushedStrips += stripRendererDraw(items, skipUnchanged);
+        M5.Display.waitDisplay();
+        totalUs += micros() - start;
+    }
+    
+    result["frame_us"] = totalUs / frames;
+    result["strips_pushed_avg"] = (float)pushedStrips / frames;
+}
+
+// 描画方式のベンチマーク（render_benchコマンド）
+void runRenderBenchmark() {
+    const int frames = AppConfig::RENDER_BENCH_FRAMES;
+    Serial.printf("Render benchmark: %d frames\n", frames);
+    
+    JsonDocument doc;
+    doc["device_id"] = AppConfig::MQTT_DEVICE_ID;
+    JsonObject bench = doc["render_bench"].to<JsonObject>();
+    bench["frames"] = frames;
+    bench["strip_height"] = AppConfig::RENDER_STRIP_HEIGHT;
+    
+    if (isSpriteReady()) {
+        benchmarkFullFrame(bench["full_frame"].to<JsonObject>(), frames);
+    } else {
+        bench["full_frame"]["error"] = "sprite unavailable";
+    }
+    
+    // フルフレーム方式で動作中は計測のために一時的に帯バッファを確保
+    bool temporaryStrips = !stripRendererIsReady();
+    if (temporaryStrips && !stripRendererSetup(M5.Display.width(), M5.Display.height())) {
+        bench["strip"]["error"] = "failed to allocate strip buffers";
+    } else {
+        bench["strip_count"] = stripRendererStripCount();
+        benchmarkStrips(bench["strip"].to<JsonObject>(), frames, false);
+        benchmarkStrips(bench["strip_skip_unchanged"].to<JsonObject>(), frames, true);
+    }
+    if (temporaryStrips) {
+        stripRendererRelease();
+    }
+    
+    // 実際の表示内容に戻す
+    stripRendererInvalidate();
+    displayAllData();
+    
+    if (!mqttPublishJson(doc)) {
+        Serial.println("Failed to send render benchmark");
     }
 }
 
@@ -357,6 +390,9 @@ void setup() {
     M5.Display.setRotation(0);  
     M5.Display.setBrightness(AppConfig::DISPLAY_BRIGHTNESS);
     
+    // レイアウト設定の読み込み（NVS、未保存ならconfig.hの既定値）
+    layoutLoad();
+    
     // WiFi選択
     int selectedWiFi = selectWiFi();
     
@@ -369,6 +405,7 @@ void setup() {
         mqttSetDataUpdateCallback(onDataUpdate);
         mqttSetCommandCallback(onCommand);
         mqttSetGetDataCallback(onGetData);
+        mqttSetLayoutChangedCallback(onLayoutChanged);
         
         // MQTT接続
         if (mqttConnect()) {
@@ -376,6 +413,11 @@ void setup() {
         } else {
             Serial.println("MQTT connection failed, but continuing...");
         }
+        
+        // UDPマルチキャスト受信（有効時のみ、データはMQTTと同じコールバックへ）
+        if (udpIngestSetup()) {
+            udpIngestSetDataUpdateCallback(onDataUpdate);
+        }
     }
     
     // スプライトの作成（画面と同じサイズ）
@@ -387,9 +429,21 @@ void setup() {
         Serial.printf("Sprite created successfully: %dx%d\n", sprite.width(), sprite.height());
     } else {
         Serial.println("ERROR: Failed to create sprite!");
-        Serial.println("Falling back to direct display rendering");
+        
+        // 内部SRAMの帯バッファによる描画にフォールバック
+        if (stripRendererSetup(M5.Display.width(), M5.Display.height())) {
+            Serial.println("Falling back to strip rendering");
+        } else {
+            Serial.println("Falling back to direct display rendering");
+        }
     }
     
+    // スナップショットの送信元（スプライトがない場合は無効）
+    snapshotSetSource(spriteCreated ? &sprite : nullptr);
+    
+    // レンダープランの作成（座標・グリフ幅の事前計算と静的レイヤー描画）
+    rendererCompile(layoutGet(), &M5.Display, M5.Display.width(), M5.Display.height(), spriteCreated);
+    
     // 初期表示
     displayAllData();
     
@@ -403,13 +457,21 @@ void loop() {
     // MQTT接続維持とメッセージ処理
     mqttLoop();
     
-    // 定期的に画面を更新
+    // UDPマルチキャスト受信の処理
+    udpIngestLoop();
+    
+    // 値の更新があれば、または定期的に画面を更新（1回のloop()で最大1回）
     static unsigned long lastUpdate = 0;
     unsigned long now = millis();
-    if (now - lastUpdate >= AppConfig::STATUS_UPDATE_INTERVAL_MS) {
+    if (displayDirty || now - lastUpdate >= AppConfig::STATUS_UPDATE_INTERVAL_MS) {
         displayAllData();
         lastUpdate = now;
     }
     
-    delay(100);
+    // スナップショットの符号化（時間上限つきで少しずつ進める）
+    snapshotLoop();
+    
+    // UDP受信有効時・スナップショット符号化中は待機を短くする
+    bool fastLoop = udpIngestIsActive() || snapshotIsBusy();
+    delay(fastLoop ? AppConfig::LOOP_DELAY_FAST_MS : AppConfig::LOOP_DELAY_MS);
 }
@@ -1,14 +1,25 @@
 #include "mqtt.h"
 #include "config.h"
+#include "layout.h"
+#include "udp_ingest.h"
+#include "snapshot.h"
 #include <ArduinoJson.h>
 
 static PubSubClient* mqttClient = nullptr;
 static DataUpdateCallback dataUpdateCallback = nullptr;
 static CommandCallback commandCallback = nullptr;
 static GetDataCallback getDataCallback = nullptr;
+static LayoutChangedCallback layoutChangedCallback = nullptr;
+
+// 設定エラーメッセージの最大長
+static constexpr size_t CONFIG_ERROR_LEN = 96;
 
 // 前方宣言
 void sendStatusResponse();
+void applyConfig(JsonVariantConst config);
+void resetConfig();
+void sendConfigResponse();
+void sendUdpStatsResponse();
 
 // MQTTコールバック関数
 void mqttCallback(char* topic, byte* payload, unsigned int length) {
@@ -16,16 +27,18 @@ void mqttCallback(char* topic, byte* payload, unsigned int length) {
     Serial.print(topic);
     Serial.print("] ");
     
-    // ペイロードを文字列に変換
-    char message[length + 1];
-    memcpy(message, payload, length);
-    message[length] = '\0';
+    // 受信バッファはスナップショット送信用に大きいため、受信メッセージは長さを制限する
+    if (length > AppConfig::MQTT_INBOUND_MAX_LEN) {
+        Serial.printf("Message too large: %u bytes (ignored)\n", length);
+        return;
+    }
     
-    Serial.println(message);
+    Serial.write(payload, length);
+    Serial.println();
     
-    // JSONパース
+    // JSONパース（ペイロードを直接解析し、スタックに複製しない）
     JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, message);
+    DeserializationError error = deserializeJson(doc, payload, length);
     
     if (error) {
         Serial.print("JSON parse failed: ");
@@ -43,41 +56,22 @@ void mqttCallback(char* topic, byte* payload, unsigned int length) {
     }
     
     bool updated = false;
+    const LayoutConfig& layout = layoutGet();
     
-    // データ1 (oil_pressure)
-    if (!doc[AppConfig::MQTT_KEY_DATA1].isNull()) {
-        float newValue = doc[AppConfig::MQTT_KEY_DATA1];
-        Serial.printf("%s: %.1f\n", AppConfig::MQTT_KEY_DATA1, newValue);
-        if (dataUpdateCallback) {
-            dataUpdateCallback(0, newValue);
-        }
-        updated = true;
-    }
-    
-    // データ2 (parison_temp)
-    if (!doc[AppConfig::MQTT_KEY_DATA2].isNull()) {
-        float newValue = doc[AppConfig::MQTT_KEY_DATA2];
-        Serial.printf("%s: %.1f\n", AppConfig::MQTT_KEY_DATA2, newValue);
-        if (dataUpdateCallback) {
-            dataUpdateCallback(1, newValue);
-        }
-        updated = true;
-    }
-    
-    // データ3 (injection_time または injction_time)
-    if (!doc[AppConfig::MQTT_KEY_DATA3].isNull()) {
-        float newValue = doc[AppConfig::MQTT_KEY_DATA3];
-        Serial.printf("%s: %.1f\n", AppConfig::MQTT_KEY_DATA3, newValue);
-        if (dataUpdateCallback) {
-            dataUpdateCallback(2, newValue);
+    // レイアウト設定のキーマッピングに従ってデータを抽出
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
+        JsonVariantConst value = doc[layout.keys[i]];
+        
+        // injection_timeはスペルミス（injction_time）の可能性に対応
+        if (value.isNull() && strcmp(layout.keys[i], "injection_time") == 0) {
+            value = doc["injction_time"];
         }
-        updated = true;
-    } else if (!doc["injction_time"].isNull()) {
-        // スペルミスの可能性に対応
-        float newValue = doc["injction_time"];
-        Serial.printf("injction_time: %.1f\n", newValue);
+        if (value.isNull()) continue;
+        
+        float newValue = value.as<float>();
+        Serial.printf("%s: %.1f\n", layout.keys[i], newValue);
         if (dataUpdateCallback) {
-            dataUpdateCallback(2, newValue);
+            dataUpdateCallback(i, newValue);
         }
         updated = true;
     }
@@ -96,13 +90,59 @@ void mqttCallback(char* topic, byte* payload, unsigned int length) {
             if (commandCallback) {
                 commandCallback(command);
             }
+        } else if (strcmp(command, "render_bench") == 0) {
+            Serial.println("Render benchmark requested");
+            if (commandCallback) {
+                commandCallback(command);
+            }
         } else if (strcmp(command, "send_status") == 0) {
             Serial.println("Status request received");
             sendStatusResponse();
+        } else if (strcmp(command, "set_config") == 0) {
+            Serial.println("Config update received");
+            applyConfig(doc["config"]);
+        } else if (strcmp(command, "reset_config") == 0) {
+            Serial.println("Config reset requested");
+            resetConfig();
+        } else if (strcmp(command, "get_config") == 0) {
+            Serial.println("Config request received");
+            sendConfigResponse();
+        } else if (strcmp(command, "udp_stats") == 0) {
+            Serial.println("UDP stats request received");
+            sendUdpStatsResponse();
+        } else if (strcmp(command, "snapshot") == 0) {
+            Serial.println("Snapshot requested");
+            snapshotRequest();
+        } else if (strcmp(command, "snapshot_stream") == 0) {
+            bool enable = doc["enable"] | true;
+            unsigned long intervalMs = doc["interval_ms"] | AppConfig::SNAPSHOT_STREAM_INTERVAL_MS;
+            Serial.printf("Snapshot streaming %s (%lu ms)\n", enable ? "on" : "off", intervalMs);
+            snapshotSetStreaming(enable, intervalMs);
         }
     }
 }
 
+// JSONを送信トピックへ送信
+bool mqttPublishJson(const JsonDocument& doc) {
+    if (!mqttClient || !mqttClient->connected()) {
+        Serial.println("MQTT not connected, cannot publish");
+        return false;
+    }
+    
+    static char jsonBuffer[AppConfig::MQTT_BUFFER_SIZE];
+    size_t length = serializeJson(doc, jsonBuffer, sizeof(jsonBuffer));
+    if (length == 0 || length >= sizeof(jsonBuffer) - 1) {
+        Serial.println("JSON too large to publish");
+        return false;
+    }
+    
+    if (!mqttClient->publish(AppConfig::MQTT_TOPIC_PUBLISH, jsonBuffer)) {
+        return false;
+    }
+    Serial.println(jsonBuffer);
+    return true;
+}
+
 // ステータス応答を送信
 void sendStatusResponse() {
     if (!mqttClient || !mqttClient->connected()) {
@@ -119,41 +159,97 @@ void sendStatusResponse() {
     JsonDocument doc;
     doc["device_id"] = AppConfig::MQTT_DEVICE_ID;
     
-    // 各データを取得
-    for (int i = 0; i < 3; i++) {
+    // 各データを取得（キー名はレイアウト設定のマッピングに従う）
+    const LayoutConfig& layout = layoutGet();
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
         float currentValue = 0.0;
         float previousValue = 0.0;
         getDataCallback(i, &currentValue, &previousValue);
         
-        if (i == 0) {
-            doc["oil_pressure_current"] = currentValue;
-            doc["oil_pressure_previous"] = previousValue;
-        } else if (i == 1) {
-            doc["parison_temp_current"] = currentValue;
-            doc["parison_temp_previous"] = previousValue;
-        } else if (i == 2) {
-            doc["injection_time_current"] = currentValue;
-            doc["injection_time_previous"] = previousValue;
-        }
+        char key[LAYOUT_KEY_MAX_LEN + 16];
+        snprintf(key, sizeof(key), "%s_current", layout.keys[i]);
+        doc[key] = currentValue;
+        snprintf(key, sizeof(key), "%s_previous", layout.keys[i]);
+        doc[key] = previousValue;
     }
     
-    // JSON文字列化
-    char jsonBuffer[512];
-    serializeJson(doc, jsonBuffer, sizeof(jsonBuffer));
-    
-    // 送信
-    if (mqttClient->publish(AppConfig::MQTT_TOPIC_PUBLISH, jsonBuffer)) {
+    if (mqttPublishJson(doc)) {
         Serial.println("Status sent successfully");
-        Serial.println(jsonBuffer);
     } else {
         Serial.println("Failed to send status");
     }
 }
 
+// 設定更新の結果を送信
+void sendConfigResult(const char* command, bool success, const char* error) {
+    JsonDocument doc;
+    doc["device_id"] = AppConfig::MQTT_DEVICE_ID;
+    doc["command"] = command;
+    doc["result"] = success ? "ok" : "error";
+    if (!success) {
+        doc["error"] = error;
+    }
+    mqttPublishJson(doc);
+}
+
+// 設定更新を適用（検証→反映→NVS保存→画面へ即時反映）
+void applyConfig(JsonVariantConst config) {
+    char error[CONFIG_ERROR_LEN] = "";
+    
+    if (!layoutApplyJson(config, error, sizeof(error))) {
+        sendConfigResult("set_config", false, error);
+        return;
+    }
+    
+    bool saved = layoutSave();
+    if (layoutChangedCallback) {
+        layoutChangedCallback();
+    }
+    sendConfigResult("set_config", saved, "applied but failed to save to NVS");
+}
+
+// 設定を既定値に戻す
+void resetConfig() {
+    layoutResetDefaults();
+    
+    bool saved = layoutSave();
+    if (layoutChangedCallback) {
+        layoutChangedCallback();
+    }
+    sendConfigResult("reset_config", saved, "reset but failed to save to NVS");
+}
+
+// 現在の設定を送信
+void sendConfigResponse() {
+    JsonDocument doc;
+    doc["device_id"] = AppConfig::MQTT_DEVICE_ID;
+    layoutToJson(doc["config"].to<JsonObject>());
+    
+    if (mqttPublishJson(doc)) {
+        Serial.println("Config sent successfully");
+    } else {
+        Serial.println("Failed to send config");
+    }
+}
+
+// UDP受信統計を送信
+void sendUdpStatsResponse() {
+    JsonDocument doc;
+    doc["device_id"] = AppConfig::MQTT_DEVICE_ID;
+    udpIngestStatsToJson(doc["udp_stats"].to<JsonObject>());
+    
+    if (mqttPublishJson(doc)) {
+        Serial.println("UDP stats sent successfully");
+    } else {
+        Serial.println("Failed to send UDP stats");
+    }
+}
+
 // MQTT初期化
 void mqttSetup(WiFiClient& wifiClient) {
     mqttClient = new PubSubClient(wifiClient);
     mqttClient->setServer(AppConfig::MQTT_BROKER_IP, AppConfig::MQTT_BROKER_PORT);
+    mqttClient->setBufferSize(AppConfig::MQTT_PACKET_BUFFER_SIZE);
     mqttClient->setCallback(mqttCallback);
 }
 
@@ -202,6 +298,14 @@ bool mqttIsConnected() {
     return mqttClient && mqttClient->connected();
 }
 
+// 任意トピックへバイナリを送信
+bool mqttPublish(const char* topic, const uint8_t* payload, size_t length) {
+    if (!mqttClient || !mqttClient->connected()) {
+        return false;
+    }
+    return mqttClient->publish(topic, payload, length);
+}
+
 // データ更新コールバックの設定
 void mqttSetDataUpdateCallback(DataUpdateCallback callback) {
     dataUpdateCallback = callback;
@@ -216,3 +320,8 @@ void mqttSetCommandCallback(CommandCallback callback) {
 void mqttSetGetDataCallback(GetDataCallback callback) {
     getDataCallback = callback;
 }
+
+// レイアウト変更コールバックの設定
+void mqttSetLayoutChangedCallback(LayoutChangedCallback callback) {
+    layoutChangedCallback = callback;
+}
@@ -2,6 +2,7 @@
 
 #include <PubSubClient.h>
 #include <WiFiClient.h>
+#include <ArduinoJson.h>
 
 // MQTT初期化
 void mqttSetup(WiFiClient& wifiClient);
@@ -15,6 +16,12 @@ void mqttLoop();
 // MQTT接続状態確認
 bool mqttIsConnected();
 
+// 任意トピックへバイナリを送信
+bool mqttPublish(const char* topic, const uint8_t* payload, size_t length);
+
+// JSONを送信トピックへ送信
+bool mqttPublishJson(const JsonDocument& doc);
+
 // データ更新コールバック関数の型定義
 typedef void (*DataUpdateCallback)(int index, float value);
 
@@ -24,6 +31,9 @@ typedef void (*CommandCallback)(const char* command);
 // 状態取得コールバック関数の型定義（現在値と前回値を取得）
 typedef void (*GetDataCallback)(int index, float* currentValue, float* previousValue);
 
+// レイアウト変更コールバック関数の型定義（set_config/reset_config適用後に呼ばれる）
+typedef void (*LayoutChangedCallback)();
+
 // データ更新コールバックの設定
 void mqttSetDataUpdateCallback(DataUpdateCallback callback);
 
@@ -33,4 +43,7 @@ void mqttSetCommandCallback(CommandCallback callback);
 // 状態取得コールバックの設定
 void mqttSetGetDataCallback(GetDataCallback callback);
 
+// レイアウト変更コールバックの設定
+void mqttSetLayoutChangedCallback(LayoutChangedCallback callback);
+
 // ステータスを送信
@@ -0,0 +1,277 @@
+#include "renderer.h"
+#include <lgfx/v1/lgfx_fonts.hpp>
+
+// ラベル文字列
+static const char* LABEL_CURRENT = "今回値: ";
+static const char* LABEL_PREVIOUS = "前回値: ";
+
+// 数値表示に使うグリフ（幅を事前計算する文字）
+static const char GLYPH_CHARS[] = "0123456789.-";
+static constexpr int GLYPH_COUNT = sizeof(GLYPH_CHARS) - 1;
+
+// 数値文字列バッファ長
+static constexpr size_t VALUE_TEXT_LEN = 24;
+
+// 固定テキスト要素（タイトル・ラベル）
+struct TextElement {
+    int16_t x;
+    int16_t y;
+    int16_t height;  // 描画高さ（帯単位描画の判定用）
+    uint8_t scale;
+    uint16_t color;
+    char text[LAYOUT_TITLE_MAX_LEN + 1];  // タイトル + ':'
+};
+
+// 数値要素（右寄せ）
+struct ValueElement {
+    int16_t rightX;
+    int16_t y;
+    uint16_t color;
+};
+
+// 1セクション分のプラン
+struct SectionPlan {
+    SectionRect rect;
+    TextElement title;
+    TextElement currentLabel;
+    TextElement previousLabel;
+    ValueElement currentValue;
+    ValueElement previousValue;
+};
+
+// 画面全体のレンダープラン
+struct RenderPlan {
+    SectionPlan sections[LAYOUT_DATA_COUNT];
+    int16_t glyphAdvance[GLYPH_COUNT];  // 数値拡大率でのグリフ送り幅
+    int16_t valueHeight;                // 数値の描画高さ
+    uint8_t valueScale;
+    uint8_t decimalPlaces;
+    uint8_t totalWidth;
+    bool compiled;
+};
+
+static RenderPlan plan = {};
+
+// 静的要素を描画済みのレイヤー（PSRAM）
+static LGFX_Sprite staticLayer;
+
+// 固定テキスト要素を作成
+static void buildText(TextElement& element, int x, int y, int scale, uint16_t color, const char* text) {
+    element.x = x;
+    element.y = y;
+    element.scale = scale;
+    element.color = color;
+    strncpy(element.text, text, sizeof(element.text) - 1);
+    element.text[sizeof(element.text) - 1] = '\0';
+}
+
+// セクションのプランを作成
+static void buildSection(SectionPlan& section, const LayoutConfig& layout, int index) {
+    const SectionRect& rect = layout.sections[index];
+    section.rect = rect;
+
+    char titleText[LAYOUT_TITLE_MAX_LEN + 1];
+    snprintf(titleText, sizeof(titleText), "%s:", layout.titles[index]);
+    buildText(section.title, rect.x + layout.titleOffset.x, rect.y + layout.titleOffset.y,
+              layout.fontTitleScale, CYAN, titleText);
+    buildText(section.currentLabel, rect.x + layout.currentOffset.x, rect.y + layout.currentOffset.y,
+              1, WHITE, LABEL_CURRENT);
+    buildText(section.previousLabel, rect.x + layout.previousOffset.x, rect.y + layout.previousOffset.y,
+              1, DARKGREY, LABEL_PREVIOUS);
+
+    section.currentValue = {(int16_t)(rect.x + layout.valueRightAlignX),
+                            (int16_t)(rect.y + layout.currentOffset.y), WHITE};
+    section.previousValue = {(int16_t)(rect.x + layout.valueRightAlignX),
+                             (int16_t)(rect.y + layout.previousOffset.y), DARKGREY};
+}
+
+// テキスト要素の描画高さを計測
+static void measureTextHeight(LovyanGFX* measureTarget, TextElement& element) {
+    measureTarget->setTextSize(element.scale);
+    element.height = measureTarget->fontHeight();
+}
+
+// 各要素の高さと数値拡大率でのグリフ送り幅を計測
+static void measureGlyphs(LovyanGFX* measureTarget) {
+    measureTarget->setFont(&fonts::lgfxJapanGothic_40);
+    for (SectionPlan& section : plan.sections) {
+        measureTextHeight(measureTarget, section.title);
+        measureTextHeight(measureTarget, section.currentLabel);
+        measureTextHeight(measureTarget, section.previousLabel);
+    }
+
+    measureTarget->setTextSize(plan.valueScale);
+    plan.valueHeight = measureTarget->fontHeight();
+
+    char glyph[2] = {0, 0};
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        glyph[0] = GLYPH_CHARS[i];
+        plan.glyphAdvance[i] = measureTarget->textWidth(glyph);
+    }
+}
+
+// 数値文字列の幅（事前計算したグリフ幅の合計、表外の文字のみ実測）
+static int32_t valueTextWidth(LovyanGFX* target, const char* text) {
+    int32_t width = 0;
+    char glyph[2] = {0, 0};
+    for (const char* p = text; *p; p++) {
+        const char* found = strchr(GLYPH_CHARS, *p);
+        if (found) {
+            width += plan.glyphAdvance[found - GLYPH_CHARS];
+        } else {
+            glyph[0] = *p;
+            width += target->textWidth(glyph);
+        }
+    }
+    return width;
+}
+
+// 静的レイヤーを作成して静的要素を描画
+static void buildStaticLayer(bool enabled, int screenWidth, int screenHeight) {
+    if (!enabled) {
+        // 帯単位描画・直接描画では使わないため解放
+        staticLayer.deleteSprite();
+        return;
+    }
+    if (staticLayer.width() != screenWidth || staticLayer.height() != screenHeight) {
+        staticLayer.deleteSprite();
+        staticLayer.setPsram(true);
+        if (!staticLayer.createSprite(screenWidth, screenHeight)) {
+            Serial.println("Renderer: failed to create static layer, drawing static elements per frame");
+            return;
+        }
+    }
+    staticLayer.fillScreen(BLACK);
+    rendererDrawStatic(&staticLayer);
+}
+
+// レイアウト設定からレンダープランを作成
+bool rendererCompile(const LayoutConfig& layout, LovyanGFX* measureTarget,
+                     int screenWidth, int screenHeight, bool useStaticLayer) {
+    if (!measureTarget) {
+        Serial.println("Renderer: measure target not set");
+        return false;
+    }
+
+    plan.valueScale = layout.fontValueScale;
+    plan.decimalPlaces = layout.valueDecimalPlaces;
+    plan.totalWidth = layout.valueTotalWidth;
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
+        buildSection(plan.sections[i], layout, i);
+    }
+    measureGlyphs(measureTarget);
+    plan.compiled = true;
+
+    buildStaticLayer(useStaticLayer, screenWidth, screenHeight);
+
+    Serial.println("Renderer: plan compiled");
+    return true;
+}
+
+// 縦範囲 [y, y + height) が帯 [bandTop, bandBottom) と重なるか
+static bool overlapsBand(int y, int height, int bandTop, int bandBottom) {
+    return y < bandBottom && y + height > bandTop;
+}
+
+// 固定テキスト要素を描画（offsetYは描画先の上端の画面座標）
+static void drawText(LovyanGFX* target, const TextElement& element, int offsetY) {
+    target->setTextSize(element.scale);
+    target->setTextColor(element.color, BLACK);
+    target->setCursor(element.x, element.y - offsetY);
+    target->print(element.text);
+}
+
+// 数値要素を右寄せで描画
+static void drawValue(LovyanGFX* target, const ValueElement& element, float value, int offsetY) {
+    char valueStr[VALUE_TEXT_LEN];
+    snprintf(valueStr, sizeof(valueStr), "%0*.*f", plan.totalWidth, plan.decimalPlaces, value);
+
+    target->setTextColor(element.color, BLACK);
+    target->setCursor(element.rightX - valueTextWidth(target, valueStr), element.y - offsetY);
+    target->print(valueStr);
+}
+
+// 帯 [bandTop, bandBottom) に掛かる静的要素を描画
+static void drawStaticRange(LovyanGFX* target, int bandTop, int bandBottom) {
+    target->setFont(&fonts::lgfxJapanGothic_40);
+    for (const SectionPlan& section : plan.sections) {
+        const SectionRect& rect = section.rect;
+        if (overlapsBand(rect.y, rect.height, bandTop, bandBottom)) {
+            target->drawRect(rect.x, rect.y - bandTop, rect.width, rect.height, WHITE);
+        }
+        for (const TextElement* element : {&section.title, &section.currentLabel, &section.previousLabel}) {
+            if (overlapsBand(element->y, element->height, bandTop, bandBottom)) {
+                drawText(target, *element, bandTop);
+            }
+        }
+    }
+}
+
+// 帯 [bandTop, bandBottom) に掛かる数値要素を描画
+static void drawValuesRange(LovyanGFX* target, const DataItem* items, int bandTop, int bandBottom) {
+    target->setFont(&fonts::lgfxJapanGothic_40);
+    target->setTextSize(plan.valueScale);
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
+        const SectionPlan& section = plan.sections[i];
+        if (overlapsBand(section.currentValue.y, plan.valueHeight, bandTop, bandBottom)) {
+            drawValue(target, section.currentValue, items[i].currentValue, bandTop);
+        }
+        if (overlapsBand(section.previousValue.y, plan.valueHeight, bandTop, bandBottom)) {
+            drawValue(target, section.previousValue, items[i].previousValue, bandTop);
+        }
+    }
+}
+
+// 静的要素を描画
+void rendererDrawStatic(LovyanGFX* target) {
+    if (!plan.compiled) return;
+    drawStaticRange(target, 0, INT16_MAX);
+}
+
+// 動的要素（数値）を描画
+void rendererDrawValues(LovyanGFX* target, const DataItem* items) {
+    if (!plan.compiled) return;
+    drawValuesRange(target, items, 0, INT16_MAX);
+}
+
+// 画面の帯 [bandY, bandY + bandHeight) を描画先の上端に合わせて描画
+void rendererDrawBand(LovyanGFX* target, const DataItem* items, int bandY, int bandHeight) {
+    if (!plan.compiled) return;
+    drawStaticRange(target, bandY, bandY + bandHeight);
+    drawValuesRange(target, items, bandY, bandY + bandHeight);
+}
+
+// 帯に掛かる数値要素の値が変化したか
+bool rendererBandChanged(const DataItem* previous, const DataItem* items, int bandY, int bandHeight) {
+    if (!plan.compiled) return true;
+    const int bandBottom = bandY + bandHeight;
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
+        const SectionPlan& section = plan.sections[i];
+        if (items[i].currentValue != previous[i].currentValue &&
+            overlapsBand(section.currentValue.y, plan.valueHeight, bandY, bandBottom)) {
+            return true;
+        }
+        if (items[i].previousValue != previous[i].previousValue &&
+            overlapsBand(section.previousValue.y, plan.valueHeight, bandY, bandBottom)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// フレームスプライトに1画面分を合成
+void rendererComposeFrame(LGFX_Sprite* frame, const DataItem* items) {
+    bool layerMatches = staticLayer.getBuffer() != nullptr &&
+                        staticLayer.width() == frame->width() &&
+                        staticLayer.height() == frame->height() &&
+                        staticLayer.bufferLength() == frame->bufferLength();
+
+    if (layerMatches) {
+        // 静的レイヤーをそのまま複製（枠・タイトル・ラベルの再描画を省略）
+        memcpy(frame->getBuffer(), staticLayer.getBuffer(), frame->bufferLength());
+    } else {
+        frame->fillScreen(BLACK);
+        rendererDrawStatic(frame);
+    }
+    rendererDrawValues(frame, items);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <M5Unified.h>
+#include "layout.h"
+
+// 表示データ（今回値・前回値）
+struct DataItem {
+    float currentValue;
+    float previousValue;
+};
+
+// レイアウト設定からレンダープランを作成する
+// 座標・フォントサイズ・グリフ幅を事前計算し、静的要素（枠・タイトル・ラベル）を
+// 静的レイヤー（PSRAMスプライト）に一度だけ描画する
+// measureTargetはグリフ幅の計測に使用する（フォント設定が変更される）
+// useStaticLayerがfalseの場合（フルフレームのスプライトがない場合）は静的レイヤーを作らない
+bool rendererCompile(const LayoutConfig& layout, LovyanGFX* measureTarget,
+                     int screenWidth, int screenHeight, bool useStaticLayer);
+
+// 静的要素（枠・タイトル・ラベル）をプランに従って描画
+void rendererDrawStatic(LovyanGFX* target);
+
+// 動的要素（今回値・前回値）をプランに従って描画
+void rendererDrawValues(LovyanGFX* target, const DataItem* items);
+
+// 画面の帯 [bandY, bandY + bandHeight) に掛かる要素のみを、描画先の上端を帯の上端として描画
+// （帯バッファへの合成用、描画先は事前に背景色で塗りつぶしておく）
+void rendererDrawBand(LovyanGFX* target, const DataItem* items, int bandY, int bandHeight);
+
+// 帯 [bandY, bandY + bandHeight) に掛かる数値要素の値がpreviousとitemsで異なるか
+// （静的要素はレイアウト変更時以外は変化しないため、帯の内容が変わり得るかを判定できる）
+bool rendererBandChanged(const DataItem* previous, const DataItem* items, int bandY, int bandHeight);
+
+// フレームスプライトに1画面分を合成（静的レイヤーの複製＋数値描画）
+void rendererComposeFrame(LGFX_Sprite* frame, const DataItem* items);
@@ -0,0 +1,149 @@
+#include "seq_tracker.h"
+#include <string.h>
+
+// 受信ビットマップの幅
+static constexpr uint32_t WINDOW_BITS = 64;
+
+// これを超えて番号が戻った場合は確認なしで再起動とみなす
+static constexpr uint32_t RESTART_JUMP = 1UL << 16;
+
+// ジッタ・遅延の平滑化係数（RFC 3550の1/16）
+static constexpr float SMOOTHING_GAIN = 1.0f / 16.0f;
+
+// 統計を初期化
+void seqStatsReset(SeqStats& stats) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+// 最新番号から再同期
+static void resync(SeqStats& stats, uint32_t seq) {
+    stats.highestSeq = seq;
+    stats.window = 1;
+    stats.tracked = 1;
+    stats.restartCount = 0;
+    stats.started = true;
+}
+
+// 判定範囲より古い番号を再起動の候補として記録し、確定したらtrue
+// 候補は直前の候補より新しく判定範囲内の番号が続いた場合のみ積み上げる
+static bool confirmRestart(SeqStats& stats, uint32_t seq, uint32_t reorderWindow, uint32_t restartConfirm) {
+    int32_t step = (int32_t)(seq - stats.restartSeq);
+    if (stats.restartCount > 0 && step > 0 && (uint32_t)step <= reorderWindow) {
+        stats.restartCount++;
+    } else {
+        stats.restartCount = 1;
+    }
+    stats.restartSeq = seq;
+    return stats.restartCount >= restartConfirm;
+}
+
+// シーケンス番号を判定して統計を更新
+SeqResult seqTrackerUpdate(SeqStats& stats, uint32_t seq, uint32_t reorderWindow, uint32_t restartConfirm) {
+    if (reorderWindow > WINDOW_BITS) reorderWindow = WINDOW_BITS;
+    stats.received++;
+
+    if (!stats.started) {
+        resync(stats, seq);
+        return SeqResult::First;
+    }
+
+    if (stats.bootChanged) {
+        // 起動IDが変わった場合は番号に関係なく再同期
+        stats.bootChanged = false;
+        stats.restarts++;
+        resync(stats, seq);
+        return SeqResult::Restarted;
+    }
+
+    // 32bitの周回を考慮した差分
+    int32_t diff = (int32_t)(seq - stats.highestSeq);
+
+    if (diff > 0) {
+        // 新しい番号：間の番号は欠落として計上（遅着すれば回復）
+        stats.lost += (uint32_t)diff - 1;
+        stats.window = ((uint32_t)diff >= WINDOW_BITS) ? 1 : ((stats.window << diff) | 1);
+        stats.highestSeq = seq;
+        stats.tracked = ((uint32_t)diff >= WINDOW_BITS - stats.tracked) ? WINDOW_BITS : stats.tracked + diff;
+        // 現在の系列が続いているため再起動の候補は破棄
+        stats.restartCount = 0;
+        return SeqResult::InOrder;
+    }
+
+    if (diff == 0) {
+        stats.duplicates++;
+        return SeqResult::Duplicate;
+    }
+
+    uint32_t age = (uint32_t)(-(int64_t)diff);
+    if (age >= reorderWindow) {
+        // 1つだけ古い番号が届いても遅着・重複として破棄し、再起動は十分な根拠がある場合のみ
+        if (age > RESTART_JUMP || confirmRestart(stats, seq, reorderWindow, restartConfirm)) {
+            stats.restarts++;
+            resync(stats, seq);
+            return SeqResult::Restarted;
+        }
+        stats.stale++;
+        return SeqResult::Stale;
+    }
+
+    uint64_t bit = 1ULL << age;
+    if (stats.window & bit) {
+        stats.duplicates++;
+        return SeqResult::Duplicate;
+    }
+
+    // 欠落扱いだった番号が遅れて到着（追跡開始より前の番号は欠落に計上していない）
+    stats.window |= bit;
+    stats.reordered++;
+    if (age < stats.tracked && stats.lost > 0) stats.lost--;
+    return SeqResult::Reordered;
+}
+
+// 送信元の起動IDを記録
+void seqTrackerSetBootId(SeqStats& stats, uint32_t bootId) {
+    if (stats.hasBootId && bootId != stats.bootId) {
+        stats.bootChanged = true;
+    }
+    stats.bootId = bootId;
+    stats.hasBootId = true;
+}
+
+// 遅延統計を更新
+void seqTrackerUpdateLatency(SeqStats& stats, uint32_t senderTimeMs, uint32_t arrivalTimeMs) {
+    // 時計は非同期のため、転送時間は基準値（最小値）との差分のみ意味を持つ
+    int32_t transit = (int32_t)(arrivalTimeMs - senderTimeMs);
+
+    if (!stats.hasTransit) {
+        stats.minTransitMs = transit;
+        stats.lastTransitMs = transit;
+        stats.hasTransit = true;
+        return;
+    }
+
+    if (transit < stats.minTransitMs) {
+        // 基準値が下がった分だけ平均遅延も補正
+        stats.delayMs += (float)(stats.minTransitMs - transit);
+        stats.minTransitMs = transit;
+    }
+
+    float delay = (float)(transit - stats.minTransitMs);
+    stats.delayMs += (delay - stats.delayMs) * SMOOTHING_GAIN;
+
+    int32_t variation = transit - stats.lastTransitMs;
+    if (variation < 0) variation = -variation;
+    stats.jitterMs += ((float)variation - stats.jitterMs) * SMOOTHING_GAIN;
+    stats.lastTransitMs = transit;
+}
+
+// 判定結果の文字列
+const char* seqResultName(SeqResult result) {
+    switch (result) {
+        case SeqResult::First:     return "first";
+        case SeqResult::InOrder:   return "in_order";
+        case SeqResult::Reordered: return "reordered";
+        case SeqResult::Duplicate: return "duplicate";
+        case SeqResult::Stale:     return "stale";
+        case SeqResult::Restarted: return "restarted";
+    }
+    return "unknown";
+}
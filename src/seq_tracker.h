@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+
+// シーケンス番号の判定結果
+enum class SeqResult {
+    First,      // 送信元からの最初のパケット
+    InOrder,    // 最新（欠落があれば欠落数に加算）
+    Reordered,  // 欠落扱いだった過去番号が遅れて到着
+    Duplicate,  // 受信済み番号
+    Stale,      // 判定範囲より古い番号（遅着・重複、または再起動の確認待ち）
+    Restarted   // 送信元の再起動（番号が大きく戻った）と判断して再同期
+};
+
+// 送信元ごとの受信統計
+// Arduino非依存（Linux上のホストツールでも同じ判定を使用する）
+struct SeqStats {
+    uint32_t received;     // 受信パケット数（重複含む）
+    uint32_t lost;         // 欠落数（遅着で回復した分は除く）
+    uint32_t duplicates;   // 重複数
+    uint32_t reordered;    // 順序入れ替わり数
+    uint32_t stale;        // 判定範囲より古く破棄した数
+    uint32_t restarts;     // 再同期回数
+    uint32_t highestSeq;   // 最新シーケンス番号
+    uint64_t window;       // 最新から過去64番号分の受信ビットマップ（bit0 = highestSeq）
+    uint32_t tracked;      // windowのうち追跡開始以降の番号数（最大64）
+    uint32_t restartSeq;   // 再起動候補（判定範囲より古い番号）の最新
+    uint32_t restartCount; // 再起動候補が昇順に続いた数
+    uint32_t bootId;       // 送信元の起動ID（"boot"）
+    bool hasBootId;
+    bool bootChanged;      // 起動IDが変わり、次の番号で再同期する
+    bool started;
+
+    // 遅延統計（送信時刻つきパケットのみ、送受信の時計は非同期）
+    int32_t minTransitMs;  // 転送時間（到着時刻 - 送信時刻）の最小値（基準値）
+    int32_t lastTransitMs;
+    float delayMs;         // 基準値からの遅延増分（指数移動平均）
+    float jitterMs;        // 到着ジッタ（RFC 3550方式）
+    bool hasTransit;
+};
+
+// 統計を初期化
+void seqStatsReset(SeqStats& stats);
+
+// シーケンス番号を判定して統計を更新
+// reorderWindowより古い番号（最大64）は遅着・重複として破棄し、
+// そのような番号がrestartConfirm個昇順に続いた場合、または番号が大きく（2^16超）戻った場合のみ
+// 送信元の再起動とみなして再同期する
+SeqResult seqTrackerUpdate(SeqStats& stats, uint32_t seq, uint32_t reorderWindow, uint32_t restartConfirm);
+
+// 送信元の起動ID（"boot"）を記録し、前回と異なれば次のseqTrackerUpdateで再同期させる
+// 判定範囲より少ない番号数で再起動した場合は番号だけでは判別できないため、起動IDで検出する
+void seqTrackerSetBootId(SeqStats& stats, uint32_t bootId);
+
+// 送信時刻（送信元の時計, ms）と到着時刻（受信側の時計, ms）から遅延統計を更新
+void seqTrackerUpdateLatency(SeqStats& stats, uint32_t senderTimeMs, uint32_t arrivalTimeMs);
+
+// 受信すべき値として扱うか（最新のみ表示に反映し、遅着・重複は破棄）
+inline bool seqResultIsFresh(SeqResult result) {
+    return result == SeqResult::First || result == SeqResult::InOrder || result == SeqResult::Restarted;
+}
+
+// 判定結果の文字列（ログ用）
+const char* seqResultName(SeqResult result);
@@ -0,0 +1,368 @@
+#include "snapshot.h"
+#include "config.h"
+#include "mqtt.h"
+#include "tile_codec.h"
+
+// チャンク形式
+static const uint8_t CHUNK_MAGIC[4] = {'S', 'N', 'P', '1'};
+static constexpr size_t CHUNK_HEADER_LEN = 16;
+static constexpr size_t TILE_HEADER_LEN = 5;
+static constexpr uint8_t FLAG_KEYFRAME = 0x01;
+static constexpr uint8_t FLAG_LAST_CHUNK = 0x02;
+
+// 1タイルの画素数・バイト数
+static constexpr size_t TILE_PIXELS = AppConfig::SNAPSHOT_TILE_SIZE * AppConfig::SNAPSHOT_TILE_SIZE;
+static constexpr size_t TILE_RAW_BYTES = TILE_PIXELS * sizeof(uint16_t);
+
+static_assert(CHUNK_HEADER_LEN + TILE_HEADER_LEN + TILE_RAW_BYTES <= AppConfig::SNAPSHOT_CHUNK_MAX_LEN,
+              "SNAPSHOT_CHUNK_MAX_LEN must hold at least one raw tile");
+static_assert(AppConfig::SNAPSHOT_CHUNK_MAX_LEN + 256 <= AppConfig::MQTT_PACKET_BUFFER_SIZE,
+              "MQTT_PACKET_BUFFER_SIZE must hold a snapshot chunk");
+
+// フレームごとの統計
+struct SnapshotStats {
+    uint32_t tilesSent;
+    uint32_t rawBytes;      // 送信タイルの無圧縮サイズ
+    uint32_t encodedBytes;  // 送信タイルの符号化後サイズ（タイルヘッダ除く）
+    uint32_t sentBytes;     // 送信した総バイト数（ヘッダ含む）
+    uint32_t copyUs;        // フレーム開始時の複製の時間
+    uint32_t encodeUs;      // 画素取得・ハッシュ・符号化の時間
+    uint32_t publishUs;     // MQTT送信の時間
+    uint32_t failedChunks;  // 送信に失敗したチャンク数
+    unsigned long startMs;
+};
+
+// 符号化の段階（MQTT送信は1回のloop()で1つまで）
+enum class SnapshotPhase {
+    Idle,
+    Encoding,       // タイルを符号化してチャンクに追加
+    SendChunk,      // 満杯のチャンクを送信
+    SendLastChunk,  // フレーム最終チャンクを送信
+    SendSummary     // 統計を送信
+};
+
+// チャンクに収まらず次のチャンクに持ち越したタイル
+struct PendingTile {
+    bool valid;
+    uint16_t index;
+    uint8_t codec;
+    uint16_t length;
+    const uint8_t* data;  // encodeBuffer または tilePixels
+    size_t rawBytes;
+};
+
+// 符号化の状態
+static LGFX_Sprite* sourceFrame = nullptr;  // 表示中の合成済みスプライト
+static LGFX_Sprite frameCopy;               // 符号化用の複製（PSRAM）
+static uint32_t* tileHashes = nullptr;
+static int tilesX = 0;
+static int tilesY = 0;
+static bool hashesValid = false;
+
+static SnapshotPhase phase = SnapshotPhase::Idle;
+static bool keyframeRequested = false;
+static bool currentKeyframe = false;
+static uint16_t frameId = 0;
+static int nextTile = 0;
+static uint16_t chunkIndex = 0;
+static SnapshotStats stats;
+static PendingTile pendingTile;
+
+// ストリーミング設定
+static bool streaming = false;
+static unsigned long streamIntervalMs = AppConfig::SNAPSHOT_STREAM_INTERVAL_MS;
+static unsigned long lastFrameStartMs = 0;
+
+// 作業バッファ
+static uint8_t chunkBuffer[AppConfig::SNAPSHOT_CHUNK_MAX_LEN];
+static size_t chunkLen = 0;
+static uint16_t chunkTiles = 0;
+static uint16_t tilePixels[TILE_PIXELS];
+static uint8_t encodeBuffer[TILE_RAW_BYTES];
+
+// リトルエンディアンで書き込む
+static void writeU16(uint8_t* dst, uint16_t value) {
+    dst[0] = value & 0xFF;
+    dst[1] = value >> 8;
+}
+
+// エラーをJSONで送信
+static void publishError(const char* error) {
+    Serial.printf("Snapshot: %s\n", error);
+
+    JsonDocument doc;
+    doc["device_id"] = AppConfig::MQTT_DEVICE_ID;
+    doc["snapshot"]["error"] = error;
+    mqttPublishJson(doc);
+}
+
+// スナップショットの送信元を設定
+void snapshotSetSource(LGFX_Sprite* frame) {
+    phase = SnapshotPhase::Idle;
+    hashesValid = false;
+    free(tileHashes);
+    tileHashes = nullptr;
+    sourceFrame = nullptr;
+    frameCopy.deleteSprite();
+
+    if (!frame || frame->getBuffer() == nullptr) {
+        Serial.println("Snapshot: no frame buffer, snapshots disabled");
+        return;
+    }
+    if (frame->getColorDepth() != 16) {
+        Serial.println("Snapshot: only 16-bit frames are supported");
+        return;
+    }
+
+    tilesX = (frame->width() + AppConfig::SNAPSHOT_TILE_SIZE - 1) / AppConfig::SNAPSHOT_TILE_SIZE;
+    tilesY = (frame->height() + AppConfig::SNAPSHOT_TILE_SIZE - 1) / AppConfig::SNAPSHOT_TILE_SIZE;
+    tileHashes = (uint32_t*)calloc(tilesX * tilesY, sizeof(uint32_t));
+    if (!tileHashes) {
+        Serial.println("Snapshot: failed to allocate tile hashes");
+        return;
+    }
+
+    frameCopy.setPsram(true);
+    frameCopy.setColorDepth(16);
+    if (!frameCopy.createSprite(frame->width(), frame->height()) ||
+        frameCopy.bufferLength() != frame->bufferLength()) {
+        Serial.println("Snapshot: failed to allocate frame copy, snapshots disabled");
+        frameCopy.deleteSprite();
+        free(tileHashes);
+        tileHashes = nullptr;
+        return;
+    }
+
+    sourceFrame = frame;
+    Serial.printf("Snapshot: %dx%d tiles of %d px\n", tilesX, tilesY, AppConfig::SNAPSHOT_TILE_SIZE);
+}
+
+// チャンクを開始（ヘッダのtileCount・flagsは送信時に確定）
+static void beginChunk() {
+    memcpy(chunkBuffer, CHUNK_MAGIC, sizeof(CHUNK_MAGIC));
+    writeU16(&chunkBuffer[4], frameId);
+    chunkBuffer[6] = 0;
+    chunkBuffer[7] = AppConfig::SNAPSHOT_TILE_SIZE;
+    writeU16(&chunkBuffer[8], sourceFrame->width());
+    writeU16(&chunkBuffer[10], sourceFrame->height());
+    writeU16(&chunkBuffer[12], chunkIndex);
+    chunkLen = CHUNK_HEADER_LEN;
+    chunkTiles = 0;
+}
+
+// チャンクを送信
+static void flushChunk(bool last) {
+    chunkBuffer[6] = (currentKeyframe ? FLAG_KEYFRAME : 0) | (last ? FLAG_LAST_CHUNK : 0);
+    writeU16(&chunkBuffer[14], chunkTiles);
+
+    uint32_t start = micros();
+    if (!mqttPublish(AppConfig::SNAPSHOT_TOPIC, chunkBuffer, chunkLen)) {
+        Serial.printf("Snapshot: failed to publish chunk %u\n", chunkIndex);
+        stats.failedChunks++;
+    }
+    stats.publishUs += micros() - start;
+    stats.sentBytes += chunkLen;
+
+    chunkIndex++;
+    beginChunk();
+}
+
+// タイル画素を連続領域に取り出す（画面端のタイルは幅・高さが小さい）
+static size_t gatherTile(int tileIndex) {
+    const int tileSize = AppConfig::SNAPSHOT_TILE_SIZE;
+    const int frameWidth = sourceFrame->width();
+    const int x0 = (tileIndex % tilesX) * tileSize;
+    const int y0 = (tileIndex / tilesX) * tileSize;
+    const int width = min(tileSize, frameWidth - x0);
+    const int height = min(tileSize, (int)sourceFrame->height() - y0);
+
+    const uint16_t* frameBuffer = (const uint16_t*)frameCopy.getBuffer();
+    for (int row = 0; row < height; row++) {
+        memcpy(&tilePixels[row * width], &frameBuffer[(y0 + row) * frameWidth + x0],
+               width * sizeof(uint16_t));
+    }
+    return width * height;
+}
+
+// 符号化済みタイルをチャンクに追加
+static void appendTile(const PendingTile& tile) {
+    uint8_t* entry = &chunkBuffer[chunkLen];
+    writeU16(&entry[0], tile.index);
+    entry[2] = tile.codec;
+    writeU16(&entry[3], tile.length);
+    memcpy(&entry[TILE_HEADER_LEN], tile.data, tile.length);
+    chunkLen += TILE_HEADER_LEN + tile.length;
+    chunkTiles++;
+
+    stats.tilesSent++;
+    stats.rawBytes += tile.rawBytes;
+    stats.encodedBytes += tile.length;
+}
+
+// 1タイルを符号化してチャンクに追加（変化のないタイルは差分フレームで省略）
+// チャンクに収まらない場合はpendingTileに持ち越してfalseを返す
+static bool encodeTile(int tileIndex) {
+    uint32_t start = micros();
+    size_t pixelCount = gatherTile(tileIndex);
+    uint32_t hash = tileHash(tilePixels, pixelCount);
+
+    if (!currentKeyframe && hash == tileHashes[tileIndex]) {
+        stats.encodeUs += micros() - start;
+        return true;
+    }
+    tileHashes[tileIndex] = hash;
+
+    // RLEが無圧縮より小さくならない場合は無圧縮で送る
+    PendingTile tile;
+    tile.valid = true;
+    tile.index = tileIndex;
+    tile.rawBytes = pixelCount * sizeof(uint16_t);
+    tile.codec = TILE_CODEC_RLE;
+    tile.length = tileRleEncode(tilePixels, pixelCount, encodeBuffer, tile.rawBytes - 1);
+    tile.data = encodeBuffer;
+    if (tile.length == 0) {
+        tile.codec = TILE_CODEC_RAW;
+        tile.length = tile.rawBytes;
+        tile.data = (const uint8_t*)tilePixels;
+    }
+    stats.encodeUs += micros() - start;
+
+    if (chunkLen + TILE_HEADER_LEN + tile.length > sizeof(chunkBuffer)) {
+        pendingTile = tile;
+        return false;
+    }
+    appendTile(tile);
+    return true;
+}
+
+// フレームの符号化を開始
+static void startFrame(bool keyframe) {
+    // 比較用ハッシュがない場合はキーフレームにする
+    currentKeyframe = keyframe || !hashesValid;
+    frameId++;
+    nextTile = 0;
+    chunkIndex = 0;
+    memset(&stats, 0, sizeof(stats));
+    stats.startMs = millis();
+    lastFrameStartMs = stats.startMs;
+    pendingTile.valid = false;
+
+    // 表示中のフレームを一括で複製（以降の再合成の影響を受けない）
+    uint32_t start = micros();
+    memcpy(frameCopy.getBuffer(), sourceFrame->getBuffer(), frameCopy.bufferLength());
+    stats.copyUs = micros() - start;
+
+    phase = SnapshotPhase::Encoding;
+    beginChunk();
+}
+
+// 時間上限までタイルを符号化（チャンクが満杯になれば送信段階へ）
+static void encodeTiles() {
+    uint32_t start = micros();
+    while (nextTile < tilesX * tilesY && micros() - start < AppConfig::SNAPSHOT_LOOP_BUDGET_US) {
+        if (!encodeTile(nextTile++)) {
+            phase = SnapshotPhase::SendChunk;
+            return;
+        }
+    }
+    if (nextTile >= tilesX * tilesY) {
+        // 変化タイルがなくても最終チャンクを送り、受信側にフレーム完了を知らせる
+        phase = SnapshotPhase::SendLastChunk;
+    }
+}
+
+// フレーム完了時に統計を送信
+static void publishSummary() {
+    JsonDocument doc;
+    doc["device_id"] = AppConfig::MQTT_DEVICE_ID;
+    JsonObject summary = doc["snapshot"].to<JsonObject>();
+    summary["frame"] = frameId;
+    summary["keyframe"] = currentKeyframe;
+    summary["width"] = sourceFrame->width();
+    summary["height"] = sourceFrame->height();
+    summary["tile_size"] = AppConfig::SNAPSHOT_TILE_SIZE;
+    summary["tiles_sent"] = stats.tilesSent;
+    summary["tiles_total"] = tilesX * tilesY;
+    summary["chunks"] = chunkIndex;
+    summary["frame_bytes"] = sourceFrame->width() * sourceFrame->height() * sizeof(uint16_t);
+    summary["raw_bytes"] = stats.rawBytes;
+    summary["encoded_bytes"] = stats.encodedBytes;
+    summary["sent_bytes"] = stats.sentBytes;
+    summary["compression_ratio"] = stats.encodedBytes > 0 ? (float)stats.rawBytes / stats.encodedBytes : 0.0f;
+    summary["copy_us"] = stats.copyUs;
+    summary["encode_us"] = stats.encodeUs;
+    summary["publish_us"] = stats.publishUs;
+    summary["failed_chunks"] = stats.failedChunks;
+    summary["elapsed_ms"] = millis() - stats.startMs;
+    mqttPublishJson(doc);
+}
+
+// キーフレームのスナップショットを要求
+bool snapshotRequest() {
+    if (!sourceFrame) {
+        publishError("frame buffer unavailable");
+        return false;
+    }
+    // 符号化中なら完了後にキーフレームを開始
+    keyframeRequested = true;
+    return true;
+}
+
+// ストリーミングの設定
+void snapshotSetStreaming(bool enable, unsigned long intervalMs) {
+    if (enable && !sourceFrame) {
+        publishError("frame buffer unavailable");
+        return;
+    }
+    streaming = enable;
+    streamIntervalMs = max(intervalMs, AppConfig::SNAPSHOT_STREAM_MIN_INTERVAL_MS);
+}
+
+// 符号化処理
+void snapshotLoop() {
+    if (!sourceFrame) return;
+
+    switch (phase) {
+        case SnapshotPhase::Idle:
+            if (keyframeRequested) {
+                keyframeRequested = false;
+                startFrame(true);
+            } else if (streaming && millis() - lastFrameStartMs >= streamIntervalMs) {
+                startFrame(false);
+            } else {
+                return;
+            }
+            // 複製を行ったloop()では符号化しない
+            break;
+
+        case SnapshotPhase::Encoding:
+            encodeTiles();
+            break;
+
+        case SnapshotPhase::SendChunk:
+            flushChunk(false);
+            if (pendingTile.valid) {
+                appendTile(pendingTile);
+                pendingTile.valid = false;
+            }
+            phase = SnapshotPhase::Encoding;
+            break;
+
+        case SnapshotPhase::SendLastChunk:
+            flushChunk(true);
+            phase = SnapshotPhase::SendSummary;
+            break;
+
+        case SnapshotPhase::SendSummary:
+            // 送信失敗があれば受信側と差分の基準がずれるため、次回はキーフレームにする
+            hashesValid = stats.failedChunks == 0;
+            publishSummary();
+            phase = SnapshotPhase::Idle;
+            break;
+    }
+}
+
+// 符号化中か
+bool snapshotIsBusy() {
+    return phase != SnapshotPhase::Idle || keyframeRequested;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <M5Unified.h>
+
+// 画面スナップショット
+// 合成済みスプライトをタイル分割・RLE符号化し、SNAPSHOT_TOPICへバイナリで送信する
+// 符号化はloop()から時間上限つきで少しずつ進め、MQTT送信は1回のloop()で1メッセージまでとして描画処理を止めない
+// フレーム開始時に合成済みスプライトをPSRAMの複製バッファへ一括コピーし、複製から符号化する
+// （符号化中に画面が再合成されても、送信内容は開始時点の1フレームのみ）
+//
+// チャンク形式（数値はリトルエンディアン）:
+//   ヘッダ16バイト: "SNP1", frameId(u16), flags(u8: bit0=キーフレーム, bit1=フレーム最終チャンク),
+//                   tileSize(u8), width(u16), height(u16), chunkIndex(u16), tileCount(u16)
+//   タイル×tileCount: tileIndex(u16), codec(u8: 0=raw, 1=RLE), length(u16), data[length]
+//   画素はスプライトのメモリ上の形式（RGB565ビッグエンディアン）
+// フレーム完了時に圧縮率・符号化時間をJSONで送信トピックへ送信する
+
+// スナップショットの送信元（合成済みスプライト、nullptrで無効）
+void snapshotSetSource(LGFX_Sprite* frame);
+
+// キーフレーム（全タイル）のスナップショットを要求
+bool snapshotRequest();
+
+// ストリーミング（前回から変化したタイルのみを定期送信）の設定
+void snapshotSetStreaming(bool enable, unsigned long intervalMs);
+
+// 符号化処理（loop()から呼ぶ）
+void snapshotLoop();
+
+// 符号化中か
+bool snapshotIsBusy();
@@ -0,0 +1,99 @@
+#include "strip_renderer.h"
+#include "config.h"
+
+// 帯バッファの本数（合成とDMA転送を交互に行う）
+static constexpr int BAND_BUFFER_COUNT = 2;
+
+static LGFX_Sprite bandBuffers[BAND_BUFFER_COUNT];
+static DataItem drawnItems[LAYOUT_DATA_COUNT];  // 前回画面に転送した値
+static bool drawnValid = false;
+static bool ready = false;
+static int screenWidth = 0;
+static int screenHeight = 0;
+static int stripCount = 0;
+
+// 帯バッファ（内部SRAM）を確保
+bool stripRendererSetup(int width, int height) {
+    stripRendererRelease();
+
+    for (LGFX_Sprite& band : bandBuffers) {
+        // PSRAMではなくDMA可能な内部SRAMに確保
+        band.setPsram(false);
+        band.setColorDepth(16);
+        if (!band.createSprite(width, AppConfig::RENDER_STRIP_HEIGHT)) {
+            Serial.println("StripRenderer: failed to allocate band buffer in internal SRAM");
+            stripRendererRelease();
+            return false;
+        }
+    }
+
+    stripCount = (height + AppConfig::RENDER_STRIP_HEIGHT - 1) / AppConfig::RENDER_STRIP_HEIGHT;
+    screenWidth = width;
+    screenHeight = height;
+    drawnValid = false;
+    ready = true;
+    Serial.printf("StripRenderer: %d strips of %dx%d\n", stripCount, width, AppConfig::RENDER_STRIP_HEIGHT);
+    return true;
+}
+
+// 帯バッファを解放
+void stripRendererRelease() {
+    for (LGFX_Sprite& band : bandBuffers) {
+        band.deleteSprite();
+    }
+    stripCount = 0;
+    drawnValid = false;
+    ready = false;
+}
+
+// 帯バッファが確保済みか
+bool stripRendererIsReady() {
+    return ready;
+}
+
+// 次回はすべての帯を転送する
+void stripRendererInvalidate() {
+    drawnValid = false;
+}
+
+// 1画面分を帯単位で描画
+int stripRendererDraw(const DataItem* items, bool skipUnchanged) {
+    if (!ready) return 0;
+
+    // 前回の転送から値が変わった数値要素に掛かる帯のみ描画する
+    const bool skip = skipUnchanged && drawnValid;
+    int pushed = 0;
+    int bufferIndex = 0;
+
+    M5.Display.startWrite();
+    for (int strip = 0; strip < stripCount; strip++) {
+        const int bandY = strip * AppConfig::RENDER_STRIP_HEIGHT;
+        const int bandHeight = min(AppConfig::RENDER_STRIP_HEIGHT, screenHeight - bandY);
+
+        if (skip && !rendererBandChanged(drawnItems, items, bandY, bandHeight)) {
+            continue;
+        }
+
+        // このバッファの前回の転送は、直前の帯の転送開始前にwaitDMA()で完了している
+        LGFX_Sprite& band = bandBuffers[bufferIndex];
+        band.fillScreen(BLACK);
+        rendererDrawBand(&band, items, bandY, bandHeight);
+
+        // 直前の帯の転送完了を待ってから転送を開始し、転送中に次の帯を合成する
+        M5.Display.waitDMA();
+        M5.Display.pushImageDMA(0, bandY, screenWidth, bandHeight, (const lgfx::swap565_t*)band.getBuffer());
+        bufferIndex = (bufferIndex + 1) % BAND_BUFFER_COUNT;
+        pushed++;
+    }
+    M5.Display.waitDMA();
+    M5.Display.endWrite();
+
+    memcpy(drawnItems, items, sizeof(drawnItems));
+    drawnValid = true;
+    return pushed;
+}
+
+// 画面全体の帯の数
+int stripRendererStripCount() {
+    return stripCount;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "renderer.h"
+
+// 帯単位描画
+// 画面を横長の帯に分けて内部SRAMの小さなバッファ（2本）で合成し、帯ごとにDMAで転送する
+// 一方の帯をDMA転送している間にもう一方を合成する
+// PSRAMのフルフレームスプライトが作成できない場合の描画方式
+
+// 帯バッファ（内部SRAM）を確保
+bool stripRendererSetup(int screenWidth, int screenHeight);
+
+// 帯バッファを解放
+void stripRendererRelease();
+
+// 帯バッファが確保済みか
+bool stripRendererIsReady();
+
+// 次回はすべての帯を転送する（他の描画で画面が上書きされた場合・レイアウト変更時など）
+void stripRendererInvalidate();
+
+// 1画面分を帯単位で描画し、転送した帯の数を返す
+// skipUnchangedがtrueなら、前回から値が変わった数値要素に掛かる帯のみ合成・転送する
+int stripRendererDraw(const DataItem* items, bool skipUnchanged);
+
+// 画面全体の帯の数
+int stripRendererStripCount();
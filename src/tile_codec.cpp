@@ -0,0 +1,60 @@
+#include "tile_codec.h"
+#include <string.h>
+
+// FNV-1aの定数
+static constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+static constexpr uint32_t FNV_PRIME = 16777619u;
+
+// 同じ画素が続く数を数える（最大TILE_RLE_MAX_RUN）
+static size_t countRun(const uint16_t* pixels, size_t start, size_t count) {
+    size_t run = 1;
+    while (start + run < count && run < TILE_RLE_MAX_RUN && pixels[start + run] == pixels[start]) {
+        run++;
+    }
+    return run;
+}
+
+// タイル画素をRLE符号化する
+size_t tileRleEncode(const uint16_t* pixels, size_t count, uint8_t* out, size_t outCapacity) {
+    size_t outLen = 0;
+    size_t index = 0;
+
+    while (index < count) {
+        size_t run = countRun(pixels, index, count);
+
+        if (run >= 2) {
+            // 繰り返し: 制御バイト + 1画素
+            if (outLen + 3 > outCapacity) return 0;
+            out[outLen++] = 0x80 | (uint8_t)(run - 1);
+            memcpy(&out[outLen], &pixels[index], sizeof(uint16_t));
+            outLen += sizeof(uint16_t);
+            index += run;
+            continue;
+        }
+
+        // 非繰り返し: 次に2画素以上の繰り返しが始まるまでをまとめて格納
+        size_t literal = 1;
+        while (index + literal < count && literal < TILE_RLE_MAX_RUN &&
+               countRun(pixels, index + literal, count) < 2) {
+            literal++;
+        }
+
+        size_t literalBytes = literal * sizeof(uint16_t);
+        if (outLen + 1 + literalBytes > outCapacity) return 0;
+        out[outLen++] = (uint8_t)(literal - 1);
+        memcpy(&out[outLen], &pixels[index], literalBytes);
+        outLen += literalBytes;
+        index += literal;
+    }
+    return outLen;
+}
+
+// タイル画素のハッシュ（速度優先で1画素単位に混ぜ込む）
+uint32_t tileHash(const uint16_t* pixels, size_t count) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < count; i++) {
+        hash ^= pixels[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// タイルの符号化方式
+enum TileCodec : uint8_t {
+    TILE_CODEC_RAW = 0,  // 無圧縮（画素をそのまま格納）
+    TILE_CODEC_RLE = 1   // ランレングス
+};
+
+// RLE形式（16bit画素単位、画素はメモリ上のバイト順のまま格納）
+//   制御バイト c & 0x80 != 0 : 続く1画素を (c & 0x7F) + 1 回繰り返す
+//   制御バイト c & 0x80 == 0 : 続く (c + 1) 画素をそのまま格納
+// Arduino非依存（ホスト側デコーダ tools/snapshot_decode.py と同じ形式）
+
+// 1制御バイトで表せる最大画素数
+inline constexpr size_t TILE_RLE_MAX_RUN = 128;
+
+// タイル画素をRLE符号化する（outCapacityに収まらない場合は0を返す）
+size_t tileRleEncode(const uint16_t* pixels, size_t count, uint8_t* out, size_t outCapacity);
+
+// タイル画素のハッシュ（FNV-1a方式、差分タイル検出用）
+uint32_t tileHash(const uint16_t* pixels, size_t count);
@@ -0,0 +1,192 @@
+#include "udp_ingest.h"
+#include "config.h"
+#include "layout.h"
+#include "seq_tracker.h"
+#include "udp_packet.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+// 送信元ごとの受信状態
+struct UdpSource {
+    char name[UDP_SOURCE_MAX_LEN];
+    SeqStats stats;
+    uint32_t lastSeenMs;
+    bool used;
+};
+
+static WiFiUDP udp;
+static bool udpActive = false;
+static DataUpdateCallback dataUpdateCallback = nullptr;
+static UdpSource sources[AppConfig::UDP_MAX_SOURCES];
+
+// 送信元に紐付かない破棄パケット数
+static uint32_t parseErrors = 0;
+static uint32_t otherDevicePackets = 0;
+
+// 受信バッファ
+static char packetBuffer[AppConfig::UDP_PACKET_MAX_LEN];
+
+// UDPマルチキャスト受信の初期化
+bool udpIngestSetup() {
+    if (!AppConfig::UDP_INGEST_ENABLED) {
+        return false;
+    }
+
+    IPAddress group;
+    if (!group.fromString(AppConfig::UDP_MULTICAST_GROUP)) {
+        Serial.printf("UDP: invalid multicast group %s\n", AppConfig::UDP_MULTICAST_GROUP);
+        return false;
+    }
+
+    if (!udp.beginMulticast(group, AppConfig::UDP_MULTICAST_PORT)) {
+        Serial.println("UDP: failed to join multicast group");
+        return false;
+    }
+
+    udpActive = true;
+    Serial.printf("UDP: listening on %s:%u\n", AppConfig::UDP_MULTICAST_GROUP,
+                  AppConfig::UDP_MULTICAST_PORT);
+    return true;
+}
+
+// 送信元を検索（未登録なら空き、空きがなければ最も古い送信元を置き換える）
+static UdpSource& findSource(const char* name) {
+    UdpSource* oldest = &sources[0];
+    for (UdpSource& source : sources) {
+        if (source.used && strcmp(source.name, name) == 0) {
+            return source;
+        }
+        if (!source.used) {
+            oldest = &source;
+        } else if (oldest->used && (int32_t)(source.lastSeenMs - oldest->lastSeenMs) < 0) {
+            oldest = &source;
+        }
+    }
+
+    if (oldest->used) {
+        Serial.printf("UDP: source table full, replacing %s\n", oldest->name);
+    }
+    memset(oldest, 0, sizeof(*oldest));
+    strncpy(oldest->name, name, sizeof(oldest->name) - 1);
+    oldest->used = true;
+    return *oldest;
+}
+
+// 解析済みパケットを処理
+static void handlePacket(const UdpPacket& packet, uint32_t arrivalMs) {
+    // "src"省略時は送信元IPで識別
+    char name[UDP_SOURCE_MAX_LEN];
+    if (packet.source[0] != '\0') {
+        strncpy(name, packet.source, sizeof(name));
+    } else {
+        strncpy(name, udp.remoteIP().toString().c_str(), sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+    }
+
+    UdpSource& source = findSource(name);
+    source.lastSeenMs = arrivalMs;
+
+    if (packet.hasBootId) {
+        seqTrackerSetBootId(source.stats, packet.bootId);
+    }
+    SeqResult result = seqTrackerUpdate(source.stats, packet.seq, AppConfig::UDP_REORDER_WINDOW,
+                                        AppConfig::UDP_RESTART_CONFIRM);
+    if (packet.hasSenderTime) {
+        seqTrackerUpdateLatency(source.stats, packet.senderTimeMs, arrivalMs);
+    }
+
+    // 遅着・重複は古い値で表示を上書きしないよう破棄
+    if (!seqResultIsFresh(result)) {
+        return;
+    }
+    if (result == SeqResult::Restarted) {
+        Serial.printf("UDP: source %s restarted (seq=%u)\n", name, (unsigned)packet.seq);
+    }
+
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
+        if (packet.hasValue[i] && dataUpdateCallback) {
+            dataUpdateCallback(i, packet.values[i]);
+        }
+    }
+}
+
+// 受信パケットの処理
+void udpIngestLoop() {
+    if (!udpActive) return;
+
+    const LayoutConfig& layout = layoutGet();
+    const char* keys[LAYOUT_DATA_COUNT];
+    for (int i = 0; i < LAYOUT_DATA_COUNT; i++) {
+        keys[i] = layout.keys[i];
+    }
+
+    for (int count = 0; count < AppConfig::UDP_MAX_PACKETS_PER_LOOP; count++) {
+        int size = udp.parsePacket();
+        if (size <= 0) break;
+
+        uint32_t arrivalMs = millis();
+        if ((size_t)size > sizeof(packetBuffer)) {
+            // 大きすぎるパケットは読み捨てる
+            udp.flush();
+            parseErrors++;
+            continue;
+        }
+        int length = udp.read(packetBuffer, sizeof(packetBuffer));
+        if (length <= 0) continue;
+
+        UdpPacket packet;
+        UdpPacketResult result = udpPacketParse(packetBuffer, length, AppConfig::MQTT_DEVICE_ID,
+                                                keys, LAYOUT_DATA_COUNT, packet);
+        if (result == UdpPacketResult::Ok) {
+            handlePacket(packet, arrivalMs);
+        } else if (result == UdpPacketResult::OtherDevice) {
+            otherDevicePackets++;
+        } else {
+            parseErrors++;
+        }
+    }
+}
+
+// UDP受信が有効か
+bool udpIngestIsActive() {
+    return udpActive;
+}
+
+// データ更新コールバックの設定
+void udpIngestSetDataUpdateCallback(DataUpdateCallback callback) {
+    dataUpdateCallback = callback;
+}
+
+// 送信元ごとの受信統計をJSONに書き出す
+void udpIngestStatsToJson(JsonObject out) {
+    out["enabled"] = udpActive;
+    out["group"] = AppConfig::UDP_MULTICAST_GROUP;
+    out["port"] = AppConfig::UDP_MULTICAST_PORT;
+    out["parse_errors"] = parseErrors;
+    out["other_device"] = otherDevicePackets;
+
+    uint32_t now = millis();
+    JsonArray list = out["sources"].to<JsonArray>();
+    for (const UdpSource& source : sources) {
+        if (!source.used) continue;
+
+        const SeqStats& stats = source.stats;
+        uint32_t expected = stats.received - stats.duplicates - stats.stale + stats.lost;
+
+        JsonObject entry = list.add<JsonObject>();
+        entry["src"] = source.name;
+        entry["received"] = stats.received;
+        entry["lost"] = stats.lost;
+        entry["duplicates"] = stats.duplicates;
+        entry["reordered"] = stats.reordered;
+        entry["stale"] = stats.stale;
+        entry["restarts"] = stats.restarts;
+        entry["highest_seq"] = stats.highestSeq;
+        entry["loss_rate"] = expected > 0 ? (float)stats.lost / expected : 0.0f;
+        entry["last_seen_ms_ago"] = now - source.lastSeenMs;
+        if (stats.hasTransit) {
+            entry["delay_ms"] = stats.delayMs;
+            entry["jitter_ms"] = stats.jitterMs;
+        }
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "mqtt.h"
+
+// UDPマルチキャスト受信の初期化（WiFi接続後に呼ぶ）
+bool udpIngestSetup();
+
+// 受信パケットの処理（loop()から呼ぶ、1回あたりの処理数は上限あり）
+void udpIngestLoop();
+
+// UDP受信が有効か
+bool udpIngestIsActive();
+
+// データ更新コールバックの設定（MQTTと同じコールバックを使用）
+void udpIngestSetDataUpdateCallback(DataUpdateCallback callback);
+
+// 送信元ごとの受信統計をJSONに書き出す
+void udpIngestStatsToJson(JsonObject out);
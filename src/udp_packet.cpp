@@ -0,0 +1,64 @@
+#include "udp_packet.h"
+#include <ArduinoJson.h>
+#include <string.h>
+
+// JSONペイロードを解析する
+UdpPacketResult udpPacketParse(const char* data, size_t length, const char* deviceId,
+                               const char* const* keys, int keyCount, UdpPacket& packet) {
+    memset(&packet, 0, sizeof(packet));
+    if (keyCount > UDP_PACKET_MAX_CHANNELS) keyCount = UDP_PACKET_MAX_CHANNELS;
+
+    JsonDocument doc;
+    if (deserializeJson(doc, data, length)) {
+        return UdpPacketResult::ParseError;
+    }
+
+    // device_idチェック（MQTTと同じく、指定がある場合のみ照合）
+    const char* targetId = doc["device_id"];
+    if (targetId && deviceId && strcmp(targetId, deviceId) != 0) {
+        return UdpPacketResult::OtherDevice;
+    }
+
+    if (!doc["seq"].is<uint32_t>()) {
+        return UdpPacketResult::MissingSeq;
+    }
+    packet.seq = doc["seq"].as<uint32_t>();
+
+    const char* source = doc["src"];
+    if (source) {
+        strncpy(packet.source, source, sizeof(packet.source) - 1);
+    }
+
+    if (doc["boot"].is<uint32_t>()) {
+        packet.bootId = doc["boot"].as<uint32_t>();
+        packet.hasBootId = true;
+    }
+
+    if (doc["ts"].is<uint32_t>()) {
+        packet.senderTimeMs = doc["ts"].as<uint32_t>();
+        packet.hasSenderTime = true;
+    }
+
+    bool found = false;
+    for (int i = 0; i < keyCount; i++) {
+        JsonVariantConst value = doc[keys[i]];
+        if (value.isNull()) continue;
+
+        packet.values[i] = value.as<float>();
+        packet.hasValue[i] = true;
+        found = true;
+    }
+    return found ? UdpPacketResult::Ok : UdpPacketResult::NoData;
+}
+
+// 解析結果の文字列
+const char* udpPacketResultName(UdpPacketResult result) {
+    switch (result) {
+        case UdpPacketResult::Ok:          return "ok";
+        case UdpPacketResult::ParseError:  return "parse_error";
+        case UdpPacketResult::OtherDevice: return "other_device";
+        case UdpPacketResult::MissingSeq:  return "missing_seq";
+        case UdpPacketResult::NoData:      return "no_data";
+    }
+    return "unknown";
+}
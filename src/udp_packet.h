@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 1パケットで扱うチャンネル数の上限
+inline constexpr int UDP_PACKET_MAX_CHANNELS = 8;
+
+// 送信元名の最大長（終端含む）
+inline constexpr size_t UDP_SOURCE_MAX_LEN = 24;
+
+// UDPデータパケット（MQTTと同じJSONペイロード＋シーケンス番号）
+// 例: {"device_id":"IPB2000_display_01","src":"gw1","boot":170000,"seq":1234,"ts":987654,"oil_pressure":123.4}
+struct UdpPacket {
+    char source[UDP_SOURCE_MAX_LEN];  // "src"（省略時は空文字、受信側で送信元IPを使用）
+    uint32_t seq;                     // "seq"（必須）
+    uint32_t bootId;                  // "boot"（任意、送信元の起動ごとに変わる値）
+    bool hasBootId;
+    uint32_t senderTimeMs;            // "ts"（任意、送信元の時計でms）
+    bool hasSenderTime;
+    float values[UDP_PACKET_MAX_CHANNELS];
+    bool hasValue[UDP_PACKET_MAX_CHANNELS];
+};
+
+// 解析結果
+enum class UdpPacketResult {
+    Ok,
+    ParseError,     // JSONとして不正
+    OtherDevice,    // 他デバイス宛
+    MissingSeq,     // シーケンス番号なし
+    NoData          // 対応するキーがない
+};
+
+// JSONペイロードを解析する
+// keysはチャンネルごとのJSONキー（keyCount <= UDP_PACKET_MAX_CHANNELS）
+// Arduino非依存（Linux上のホストツールでも同じ解析を使用する）
+UdpPacketResult udpPacketParse(const char* data, size_t length, const char* deviceId,
+                               const char* const* keys, int keyCount, UdpPacket& packet);
+
+// 解析結果の文字列（ログ用）
+const char* udpPacketResultName(UdpPacketResult result);
@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+"""画面スナップショットのデコーダ（ホスト側）
+
+snapshot / snapshot_stream コマンドで送信されるタイルチャンク（src/snapshot.h の形式）を
+復号し、フレーム完了ごとにPPM画像として保存する。
+デバイスが送信する統計（圧縮率・符号化時間）も表示する。
+チャンクの欠落（frameId・chunkIndexの不連続）を検出した場合はそのフレームを破棄し、
+次のキーフレームまで差分フレームを適用しない。
+
+例:
+    # MQTTで受信（paho-mqttが必要）
+    python3 tools/snapshot_decode.py --broker 192.168.1.65 --out snapshots
+    mosquitto_pub -h 192.168.1.65 -t toIPB2000-2_display -m '{"device_id":"IPB2000_display_01","command":"snapshot"}'
+
+    # 保存済みチャンク（1メッセージ1ファイル）を復号
+    python3 tools/snapshot_decode.py --files chunk_000.bin chunk_001.bin --out snapshots
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+MAGIC = b"SNP1"
+CHUNK_HEADER = struct.Struct("<4sHBBHHHH")
+TILE_HEADER = struct.Struct("<HBH")
+FLAG_KEYFRAME = 0x01
+FLAG_LAST_CHUNK = 0x02
+CODEC_RAW = 0
+CODEC_RLE = 1
+
+FRAME_ID_MODULO = 0x10000
+
+DEFAULT_SNAPSHOT_TOPIC = "fromIPB2000-2_display/snapshot"
+DEFAULT_STATUS_TOPIC = "fromIPB2000-2_display"
+
+
+def decode_rle(data, pixel_count):
+    """RLE（src/tile_codec.h の形式）を復号して画素バイト列を返す"""
+    out = bytearray()
+    index = 0
+    while index < len(data):
+        control = data[index]
+        index += 1
+        if control & 0x80:
+            out += data[index:index + 2] * ((control & 0x7F) + 1)
+            index += 2
+        else:
+            length = (control + 1) * 2
+            out += data[index:index + length]
+            index += length
+    if len(out) != pixel_count * 2:
+        raise ValueError("RLE tile decoded to %d bytes, expected %d" % (len(out), pixel_count * 2))
+    return bytes(out)
+
+
+class SnapshotDecoder:
+    """チャンクを順に受け取り、画面バッファ（RGB565ビッグエンディアン）を復元する"""
+
+    def __init__(self, out_dir):
+        self.out_dir = out_dir
+        self.canvas = None
+        self.width = self.height = self.tile_size = 0
+        self.frame_id = None
+        self.synced = False          # canvasが直前の完了フレームと一致しているか
+        self.last_complete = None    # 直前に完了したフレームのframe_id
+        self.expected_chunk = None   # 受信中フレームの次のchunk_index（受信中でなければNone）
+        self.reset_frame_stats()
+
+    def reset_frame_stats(self):
+        self.tiles = 0
+        self.raw_bytes = 0
+        self.encoded_bytes = 0
+        self.received_bytes = 0
+        self.decode_seconds = 0.0
+
+    def feed(self, chunk):
+        start = time.perf_counter()
+        magic, frame_id, flags, tile_size, width, height, chunk_index, tile_count = CHUNK_HEADER.unpack_from(chunk)
+        if magic != MAGIC:
+            raise ValueError("not a snapshot chunk")
+
+        keyframe = bool(flags & FLAG_KEYFRAME)
+        if not self.check_continuity(frame_id, chunk_index, keyframe):
+            return
+        if keyframe and chunk_index == 0:
+            self.width, self.height, self.tile_size = width, height, tile_size
+            self.canvas = bytearray(width * height * 2)
+        if (width, height, tile_size) != (self.width, self.height, self.tile_size):
+            self.lose_sync(frame_id, "frame geometry changed")
+            return
+        if chunk_index == 0:
+            self.reset_frame_stats()
+        self.frame_id = frame_id
+        self.expected_chunk = chunk_index + 1
+
+        offset = CHUNK_HEADER.size
+        for _ in range(tile_count):
+            tile_index, codec, length = TILE_HEADER.unpack_from(chunk, offset)
+            offset += TILE_HEADER.size
+            self.paint_tile(tile_index, codec, chunk[offset:offset + length])
+            offset += length
+            self.encoded_bytes += length
+
+        self.received_bytes += len(chunk)
+        self.decode_seconds += time.perf_counter() - start
+        if flags & FLAG_LAST_CHUNK:
+            self.expected_chunk = None
+            self.last_complete = frame_id
+            self.synced = True
+            self.finish_frame(keyframe)
+
+    def check_continuity(self, frame_id, chunk_index, keyframe):
+        """チャンクが欠落なく続いているかを確認する（欠落時はキーフレームまで破棄）"""
+        if chunk_index == 0:
+            if self.expected_chunk is not None:
+                # 前のフレームの最終チャンクが届いていない
+                self.lose_sync(self.frame_id, "missing last chunk")
+            if keyframe:
+                return True
+            if not self.synced:
+                print("frame %d: waiting for keyframe" % frame_id, file=sys.stderr)
+                return False
+            if frame_id != (self.last_complete + 1) % FRAME_ID_MODULO:
+                self.lose_sync(frame_id, "missing frame(s) after %d" % self.last_complete)
+                return False
+            return True
+
+        if self.expected_chunk is None:
+            # フレームの先頭チャンクを受信していない（途中から購読した、または破棄済みのフレーム）
+            print("frame %d: chunk %d without its first chunk, ignored" % (frame_id, chunk_index),
+                  file=sys.stderr)
+            return False
+        if frame_id != self.frame_id or chunk_index != self.expected_chunk:
+            self.lose_sync(frame_id, "expected frame %d chunk %d, got frame %d chunk %d" % (
+                self.frame_id, self.expected_chunk, frame_id, chunk_index))
+            return False
+        return True
+
+    def lose_sync(self, frame_id, reason):
+        """フレームを破棄し、次のキーフレームまで差分を適用しない"""
+        print("frame %d: %s, discarding frame and waiting for keyframe" % (frame_id, reason),
+              file=sys.stderr)
+        self.synced = False
+        self.expected_chunk = None
+
+    def paint_tile(self, tile_index, codec, data):
+        tiles_x = (self.width + self.tile_size - 1) // self.tile_size
+        x0 = (tile_index % tiles_x) * self.tile_size
+        y0 = (tile_index // tiles_x) * self.tile_size
+        width = min(self.tile_size, self.width - x0)
+        height = min(self.tile_size, self.height - y0)
+
+        pixels = decode_rle(data, width * height) if codec == CODEC_RLE else bytes(data)
+        row_bytes = width * 2
+        for row in range(height):
+            dst = ((y0 + row) * self.width + x0) * 2
+            self.canvas[dst:dst + row_bytes] = pixels[row * row_bytes:(row + 1) * row_bytes]
+
+        self.tiles += 1
+        self.raw_bytes += width * height * 2
+
+    def finish_frame(self, keyframe):
+        ratio = self.raw_bytes / self.encoded_bytes if self.encoded_bytes else 0.0
+        print("frame %d (%s): tiles=%d received=%d B ratio=%.1f decode=%.1f ms" % (
+            self.frame_id, "key" if keyframe else "delta", self.tiles, self.received_bytes,
+            ratio, self.decode_seconds * 1000.0))
+        if self.out_dir:
+            self.write_ppm(os.path.join(self.out_dir, "snapshot_%05d.ppm" % self.frame_id))
+
+    def write_ppm(self, path):
+        os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+        rgb = bytearray(self.width * self.height * 3)
+        for i in range(self.width * self.height):
+            value = (self.canvas[i * 2] << 8) | self.canvas[i * 2 + 1]
+            r = (value >> 11) & 0x1F
+            g = (value >> 5) & 0x3F
+            b = value & 0x1F
+            rgb[i * 3] = (r << 3) | (r >> 2)
+            rgb[i * 3 + 1] = (g << 2) | (g >> 4)
+            rgb[i * 3 + 2] = (b << 3) | (b >> 2)
+        with open(path, "wb") as f:
+            f.write(b"P6\n%d %d\n255\n" % (self.width, self.height))
+            f.write(rgb)
+
+
+def run_mqtt(args, decoder):
+    try:
+        import paho.mqtt.client as mqtt
+    except ImportError:
+        sys.exit("paho-mqtt is required for --broker (pip install paho-mqtt)")
+
+    def on_connect(client, userdata, flags, *rest):
+        client.subscribe(args.topic)
+        client.subscribe(args.status_topic)
+
+    def on_message(client, userdata, message):
+        if message.topic == args.topic:
+            decoder.feed(message.payload)
+            return
+        try:
+            status = json.loads(message.payload)
+        except ValueError:
+            return
+        if "snapshot" in status:
+            print("device: %s" % json.dumps(status["snapshot"]))
+
+    client = mqtt.Client()
+    client.on_connect = on_connect
+    client.on_message = on_message
+    client.connect(args.broker, args.port)
+    client.loop_forever()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode display snapshot chunks")
+    parser.add_argument("--broker", help="MQTT broker address")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--topic", default=DEFAULT_SNAPSHOT_TOPIC)
+    parser.add_argument("--status-topic", default=DEFAULT_STATUS_TOPIC)
+    parser.add_argument("--files", nargs="*", help="chunk files (one MQTT message per file)")
+    parser.add_argument("--out", default="snapshots", help="output directory for PPM images")
+    args = parser.parse_args()
+
+    decoder = SnapshotDecoder(args.out)
+    if args.files:
+        for path in args.files:
+            with open(path, "rb") as f:
+                decoder.feed(f.read())
+    elif args.broker:
+        run_mqtt(args, decoder)
+    else:
+        parser.error("either --broker or --files is required")
+
+
+if __name__ == "__main__":
+    main()
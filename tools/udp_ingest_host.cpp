@@ -0,0 +1,186 @@
+// UDPマルチキャスト受信のホスト版（Linux）
+// ファームウェアと同じ解析（udp_packet）・シーケンス判定（seq_tracker）を使用し、
+// 送信元ごとの欠落・重複・順序入れ替わり・遅延を表示する
+//
+// ビルド（ArduinoJsonはPlatformIOが取得したものを使用）:
+//   g++ -std=c++17 -O2 -Isrc -I.pio/libdeps/tab5/ArduinoJson/src
+//       tools/udp_ingest_host.cpp src/udp_packet.cpp src/seq_tracker.cpp -o udp_ingest_host
+//
+// ループバックでの確認:
+//   ./udp_ingest_host --loopback --duration 30 &
+//   python3 tools/udp_mcast_send.py --loopback --count 1000 --drop 0.02 --dup 0.01 --reorder 0.02
+
+#include <cstddef>
+#include <cstdint>
+
+// 既定値・判定パラメータはファームウェアの設定をそのまま使用
+#include "config.h"
+#include "seq_tracker.h"
+#include "udp_packet.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+// キーマッピングの既定値（実行時のset_configによる変更は反映しない）
+static const char* const DEFAULT_KEYS[] = {
+    AppConfig::MQTT_KEY_DATA1, AppConfig::MQTT_KEY_DATA2, AppConfig::MQTT_KEY_DATA3,
+};
+static constexpr int DEFAULT_KEY_COUNT = sizeof(DEFAULT_KEYS) / sizeof(DEFAULT_KEYS[0]);
+
+struct Options {
+    const char* group = AppConfig::UDP_MULTICAST_GROUP;
+    uint16_t port = AppConfig::UDP_MULTICAST_PORT;
+    const char* deviceId = AppConfig::MQTT_DEVICE_ID;
+    bool loopback = false;
+    bool verbose = false;
+    int durationSec = 10;
+};
+
+// 単調増加のミリ秒（ファームウェアのmillis()相当）
+static uint32_t monotonicMs() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--group" && hasValue) {
+            options.group = argv[++i];
+        } else if (arg == "--port" && hasValue) {
+            options.port = (uint16_t)atoi(argv[++i]);
+        } else if (arg == "--device-id" && hasValue) {
+            options.deviceId = argv[++i];
+        } else if (arg == "--duration" && hasValue) {
+            options.durationSec = atoi(argv[++i]);
+        } else if (arg == "--loopback") {
+            options.loopback = true;
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else {
+            fprintf(stderr, "usage: %s [--group ADDR] [--port N] [--device-id ID] "
+                            "[--duration SEC] [--loopback] [--verbose]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// マルチキャストグループに参加したソケットを作成
+static int openSocket(const Options& options) {
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(sock);
+        return -1;
+    }
+
+    ip_mreq membership = {};
+    membership.imr_multiaddr.s_addr = inet_addr(options.group);
+    membership.imr_interface.s_addr = options.loopback ? inet_addr("127.0.0.1") : htonl(INADDR_ANY);
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+        perror("IP_ADD_MEMBERSHIP");
+        close(sock);
+        return -1;
+    }
+
+    // 受信待ちを区切って終了時間を判定する
+    timeval timeout = {0, 200 * 1000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return sock;
+}
+
+// 送信元ごとの統計を表示（ファームウェアのudp_statsと同じ項目）
+static void printStats(const std::map<std::string, SeqStats>& sources, uint32_t parseErrors) {
+    printf("{\"parse_errors\":%u,\"sources\":[", parseErrors);
+    bool first = true;
+    for (const auto& entry : sources) {
+        const SeqStats& stats = entry.second;
+        uint32_t expected = stats.received - stats.duplicates - stats.stale + stats.lost;
+        printf("%s{\"src\":\"%s\",\"received\":%u,\"lost\":%u,\"duplicates\":%u,\"reordered\":%u,"
+               "\"stale\":%u,\"restarts\":%u,\"highest_seq\":%u,\"loss_rate\":%.4f",
+               first ? "" : ",", entry.first.c_str(), stats.received, stats.lost, stats.duplicates,
+               stats.reordered, stats.stale, stats.restarts, stats.highestSeq,
+               expected > 0 ? (double)stats.lost / expected : 0.0);
+        if (stats.hasTransit) {
+            printf(",\"delay_ms\":%.2f,\"jitter_ms\":%.2f", stats.delayMs, stats.jitterMs);
+        }
+        printf("}");
+        first = false;
+    }
+    printf("]}\n");
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    int sock = openSocket(options);
+    if (sock < 0) return 1;
+    fprintf(stderr, "listening on %s:%u for %d s\n", options.group, options.port, options.durationSec);
+
+    std::map<std::string, SeqStats> sources;
+    uint32_t parseErrors = 0;
+    char buffer[AppConfig::UDP_PACKET_MAX_LEN];
+    uint32_t endMs = monotonicMs() + (uint32_t)options.durationSec * 1000;
+
+    while ((int32_t)(endMs - monotonicMs()) > 0) {
+        sockaddr_in sender = {};
+        socklen_t senderLen = sizeof(sender);
+        ssize_t length = recvfrom(sock, buffer, sizeof(buffer), 0, (sockaddr*)&sender, &senderLen);
+        if (length <= 0) continue;
+        uint32_t arrivalMs = monotonicMs();
+
+        UdpPacket packet;
+        UdpPacketResult result = udpPacketParse(buffer, (size_t)length, options.deviceId,
+                                                DEFAULT_KEYS, DEFAULT_KEY_COUNT, packet);
+        if (result != UdpPacketResult::Ok) {
+            parseErrors++;
+            if (options.verbose) printf("drop: %s\n", udpPacketResultName(result));
+            continue;
+        }
+
+        std::string name = packet.source[0] ? packet.source : inet_ntoa(sender.sin_addr);
+        auto inserted = sources.emplace(name, SeqStats{});
+        SeqStats& stats = inserted.first->second;
+        if (inserted.second) seqStatsReset(stats);
+
+        if (packet.hasBootId) {
+            seqTrackerSetBootId(stats, packet.bootId);
+        }
+        SeqResult seqResult = seqTrackerUpdate(stats, packet.seq, AppConfig::UDP_REORDER_WINDOW,
+                                                AppConfig::UDP_RESTART_CONFIRM);
+        if (packet.hasSenderTime) {
+            seqTrackerUpdateLatency(stats, packet.senderTimeMs, arrivalMs);
+        }
+        if (options.verbose) {
+            printf("%s seq=%u %s\n", name.c_str(), packet.seq, seqResultName(seqResult));
+        }
+    }
+
+    close(sock);
+    printStats(sources, parseErrors);
+    return 0;
+}
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""UDPマルチキャスト送信ツール（UDP受信経路の動作確認用）
+
+MQTTと同じJSONペイロードに "src" / "boot" / "seq" / "ts" を付けて送信する。
+"boot" は実行ごとに変わる値（既定は起動時刻）で、受信側は変化を検出すると番号に関係なく再同期する。
+欠落・重複・順序入れ替わりを意図的に発生させ、受信側の統計を確認できる。
+
+例（Linuxのループバックで確認）:
+    python3 tools/udp_mcast_send.py --loopback --count 1000 --drop 0.02 --dup 0.01 --reorder 0.02
+"""
+
+import argparse
+import json
+import math
+import random
+import socket
+import struct
+import time
+
+DEFAULT_GROUP = "239.1.20.1"
+DEFAULT_PORT = 5020
+DEFAULT_DEVICE_ID = "IPB2000_display_01"
+DEFAULT_KEYS = ["oil_pressure", "parison_temp", "injection_time"]
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Send test packets to the UDP multicast ingest path")
+    parser.add_argument("--group", default=DEFAULT_GROUP)
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT)
+    parser.add_argument("--device-id", default=DEFAULT_DEVICE_ID)
+    parser.add_argument("--src", default="gw1", help="source name (src field)")
+    parser.add_argument("--keys", default=",".join(DEFAULT_KEYS), help="comma separated JSON keys")
+    parser.add_argument("--count", type=int, default=100)
+    parser.add_argument("--rate", type=float, default=50.0, help="packets per second")
+    parser.add_argument("--start-seq", type=int, default=0)
+    parser.add_argument("--boot", type=int, default=None, help="boot id (default: current time)")
+    parser.add_argument("--no-boot", action="store_true", help="omit the boot field")
+    parser.add_argument("--drop", type=float, default=0.0, help="drop probability")
+    parser.add_argument("--dup", type=float, default=0.0, help="duplicate probability")
+    parser.add_argument("--reorder", type=float, default=0.0, help="probability to delay a packet behind the next one")
+    parser.add_argument("--loopback", action="store_true", help="send via the loopback interface")
+    parser.add_argument("--ttl", type=int, default=1)
+    parser.add_argument("--seed", type=int, default=None)
+    return parser.parse_args()
+
+
+def open_socket(args):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, struct.pack("b", args.ttl))
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+    if args.loopback:
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_IF, socket.inet_aton("127.0.0.1"))
+    return sock
+
+
+def build_payload(args, keys, seq, start_time):
+    elapsed = time.monotonic() - start_time
+    payload = {
+        "device_id": args.device_id,
+        "src": args.src,
+        "seq": seq & 0xFFFFFFFF,
+        "ts": int(time.monotonic() * 1000) & 0xFFFFFFFF,
+    }
+    if args.boot is not None:
+        payload["boot"] = args.boot & 0xFFFFFFFF
+    for index, key in enumerate(keys):
+        payload[key] = round(100.0 * (index + 1) + 10.0 * math.sin(elapsed + index), 1)
+    return json.dumps(payload, separators=(",", ":")).encode()
+
+
+def main():
+    args = parse_args()
+    rng = random.Random(args.seed)
+    keys = [key for key in args.keys.split(",") if key]
+    if args.no_boot:
+        args.boot = None
+    elif args.boot is None:
+        args.boot = int(time.time())
+    sock = open_socket(args)
+    destination = (args.group, args.port)
+
+    interval = 1.0 / args.rate if args.rate > 0 else 0.0
+    start_time = time.monotonic()
+    held = None
+    sent = dropped = duplicated = reordered = 0
+
+    for offset in range(args.count):
+        seq = args.start_seq + offset
+        data = build_payload(args, keys, seq, start_time)
+
+        if rng.random() < args.drop:
+            dropped += 1
+        elif held is None and rng.random() < args.reorder:
+            held = data
+            reordered += 1
+        else:
+            sock.sendto(data, destination)
+            sent += 1
+            if rng.random() < args.dup:
+                sock.sendto(data, destination)
+                duplicated += 1
+            if held is not None:
+                sock.sendto(held, destination)
+                sent += 1
+                held = None
+
+        if interval > 0:
+            time.sleep(interval)
+
+    if held is not None:
+        sock.sendto(held, destination)
+        sent += 1
+
+    print(json.dumps({"sent": sent, "dropped": dropped, "duplicated": duplicated, "reordered": reordered}))
+
+
+if __name__ == "__main__":
+    main()